@@ -0,0 +1,18 @@
+#ifndef _SWITCHIDENT_BENCH_H_
+#define _SWITCHIDENT_BENCH_H_
+
+#include <switch.h>
+
+// Host frame benchmark, enabled with `bench = 1` in the fake backend config. The scripted input walks through
+// `page_count` pages; every frame's time is attributed to the page it drew, and the framebuffer of each page's
+// first visit is hashed and compared against the golden file.
+namespace Bench {
+    // Called once the main loop body for `frame` has finished and presented.
+    void EndFrame(u64 frame, u64 elapsed_ns);
+    // Prints per-page frame times and golden results. Returns false if a checked page was not captured, is missing
+    // from the golden file or differs from its hash. With `golden_record = 1` the captured hashes are written to the
+    // golden file instead of being checked.
+    bool Finish(void);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef _SWITCHIDENT_FAKE_BACKEND_H_
+#define _SWITCHIDENT_FAKE_BACKEND_H_
+
+#include <switch.h>
+
+// Values and latencies returned by the host libnx stand-in. Defaults describe a docked retail Erista unit; any
+// field can be overridden from the file named by SWITCHIDENT_FAKE_CONFIG (see host/fake_backend.ini).
+namespace FakeBackend {
+    enum FakeService {
+        FakeService_Romfs = 0,
+        FakeService_Socket,
+        FakeService_Set,
+        FakeService_SetSys,
+        FakeService_SetCal,
+        FakeService_Spl,
+        FakeService_Nifm,
+        FakeService_Applet,
+        FakeService_Apm,
+        FakeService_Ns,
+        FakeService_Psm,
+        FakeService_Clkrst,
+        FakeService_Pcv,
+        FakeService_WlanInf,
+        FakeService_Fs,
+        FakeService_Hid,
+        FakeService_Count
+    };
+
+    struct Config {
+        u8 hos_version[3];
+        SetSysFirmwareVersion firmware_version;
+        SetSysSerialNumber serial_number;
+        SetBatteryLot battery_lot;
+        SetCalBdAddress bd_addr;
+        SetCalMacAddress mac_addr;
+        u64 hardware_type;
+        u64 dram_id;
+        u64 device_id;
+        bool is_retail;
+        SetRegion region;
+        u64 language;
+        u32 cpu_clock;
+        u32 gpu_clock;
+        u32 emc_clock;
+        bool wlan_enabled;
+        bool bluetooth_enabled;
+        bool nfc_enabled;
+        bool auto_update_enabled;
+        bool console_info_upload_enabled;
+        s32 wlan_rssi;
+        u32 battery_percentage;
+        PsmChargerType charger_type;
+        PsmBatteryVoltageState voltage_state;
+        bool charging_enabled;
+        bool enough_power_supplied;
+        AppletOperationMode operation_mode;
+        bool sd_inserted;
+        bool gamecard_inserted;
+        s64 total_space[NcmStorageId_Any];
+        s64 free_space[NcmStorageId_Any];
+        char ip_address[32];
+        u32 npad_style_sets[9]; // Handheld, then No1-No8.
+        u32 npad_battery_level;
+
+        u64 latency_us[FakeService_Count]; // Added to every call into the service, including its init.
+        u64 latency_jitter_us[FakeService_Count]; // Plus a uniformly distributed [0, jitter] on top of that.
+        u64 seed;                          // Seeds the jitter; 0 is a valid seed.
+        u64 event_interval_ms;             // 0: OS state-change events never fire.
+        u64 max_frames;                    // 0: run until the window is closed.
+        u64 page_interval;                 // Frames between scripted "down" presses; 0 disables input.
+        u64 background_at_frame;           // Frame at which the app is sent to the background; 0: never.
+        u64 background_frames;             // How many main loop iterations it stays there.
+        char stats_path[256];
+
+        bool bench;                        // Redraw every frame and report per-page frame times (see host/source/bench.cpp).
+        u64 page_count;                    // Pages the scripted "down" presses cycle through.
+        u32 golden_pages;                  // Mask of pages whose framebuffer hash is checked against golden_path.
+        char golden_path[256];             // Empty: no golden-image check.
+        bool golden_record;                // Write the golden file from this run instead of checking against it.
+    };
+
+    const Config *GetConfig(void);
+
+    // Sleeps for the configured latency of `service`, plus its jitter if it has any.
+    void Call(FakeService service);
+}
+
+#endif
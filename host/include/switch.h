@@ -0,0 +1,388 @@
+// Host stand-in for <switch.h>: the subset of the libnx API SwitchIdent uses, backed by the fake in
+// host/source/fake_libnx.cpp. Types keep libnx's names and the fields the app reads; layouts are not meant to
+// match the real ones.
+#ifndef _SWITCHIDENT_HOST_SWITCH_H_
+#define _SWITCHIDENT_HOST_SWITCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef __uint128_t u128;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+
+typedef u32 Result;
+typedef u32 Handle;
+
+#define BIT(n) (1U << (n))
+#define INVALID_HANDLE 0
+
+#define R_SUCCEEDED(res) ((res) == 0)
+#define R_FAILED(res) ((res) != 0)
+#define MAKERESULT(module, description) ((((module) & 0x1FF)) | ((description) & 0x1FFF) << 9)
+
+enum {
+    Module_Libnx = 345
+};
+
+enum {
+    LibnxError_NotInitialized = 2,
+    LibnxError_IncompatSysVer = 100
+};
+
+typedef struct {
+    u32 id;
+} Service;
+
+// Kernel objects
+typedef struct {
+    Handle revent;
+    Handle wevent;
+    bool autoclear;
+} Event;
+
+typedef struct {
+    Handle handle;
+    bool autoclear;
+} UEvent;
+
+typedef enum {
+    WaiterType_Handle = 0,
+    WaiterType_UEvent
+} WaiterType;
+
+typedef struct {
+    WaiterType type;
+    Handle handle;
+    UEvent *event;
+} Waiter;
+
+// set, setsys, setcal
+typedef enum {
+    SetRegion_JPN = 0,
+    SetRegion_USA = 1,
+    SetRegion_EUR = 2,
+    SetRegion_AUS = 3,
+    SetRegion_HTK = 4,
+    SetRegion_CHN = 5
+} SetRegion;
+
+typedef struct {
+    u8 major;
+    u8 minor;
+    u8 micro;
+    u8 padding1;
+    u8 revision_major;
+    u8 revision_minor;
+    u8 padding2;
+    u8 padding3;
+    char platform[0x20];
+    char version_hash[0x40];
+    char display_version[0x18];
+    char display_title[0x80];
+} SetSysFirmwareVersion;
+
+typedef struct {
+    char number[0x18];
+} SetSysSerialNumber;
+
+typedef struct {
+    char lot[0x18];
+} SetBatteryLot;
+
+typedef struct {
+    u8 bd_addr[0x6];
+} SetCalBdAddress;
+
+typedef struct {
+    u8 addr[0x6];
+} SetCalMacAddress;
+
+// spl
+typedef enum {
+    SplConfigItem_DramId = 5,
+    SplConfigItem_HardwareType = 15,
+    SplConfigItem_IsRetail = 16,
+    SplConfigItem_IsRecoveryBoot = 17,
+    SplConfigItem_DeviceId = 18,
+    SplConfigItem_IsKiosk = 64
+} SplConfigItem;
+
+// pcv, clkrst
+typedef enum {
+    PcvModule_CpuBus = 0,
+    PcvModule_GPU = 1,
+    PcvModule_EMC = 56
+} PcvModule;
+
+typedef u32 PcvModuleId;
+
+typedef struct {
+    Service s;
+} ClkrstSession;
+
+// ns, fs
+typedef enum {
+    NcmStorageId_None = 0,
+    NcmStorageId_Host = 1,
+    NcmStorageId_GameCard = 2,
+    NcmStorageId_BuiltInSystem = 3,
+    NcmStorageId_BuiltInUser = 4,
+    NcmStorageId_SdCard = 5,
+    NcmStorageId_Any = 6
+} NcmStorageId;
+
+typedef struct {
+    Service s;
+} FsDeviceOperator;
+
+typedef struct {
+    Service s;
+} FsEventNotifier;
+
+// psm
+typedef enum {
+    PsmChargerType_Unconnected = 0,
+    PsmChargerType_EnoughPower = 1,
+    PsmChargerType_LowPower = 2,
+    PsmChargerType_NotSupported = 3
+} PsmChargerType;
+
+typedef enum {
+    PsmBatteryVoltageState_NeedsShutdown = 0,
+    PsmBatteryVoltageState_NeedsSleep = 1,
+    PsmBatteryVoltageState_NoPerformanceBoost = 2,
+    PsmBatteryVoltageState_Normal = 3
+} PsmBatteryVoltageState;
+
+typedef struct {
+    Service s;
+    Event StateChangeEvent;
+} PsmSession;
+
+// wlaninf, nifm
+typedef enum {
+    WlanInfState_NotInitialized = 0,
+    WlanInfState_Connected = 3
+} WlanInfState;
+
+typedef enum {
+    NifmServiceType_User = 0
+} NifmServiceType;
+
+// applet
+typedef enum {
+    AppletOperationMode_Handheld = 0,
+    AppletOperationMode_Console = 1
+} AppletOperationMode;
+
+typedef enum {
+    AppletFocusState_InFocus = 1,
+    AppletFocusState_OutOfFocus = 2,
+    AppletFocusState_Background = 3
+} AppletFocusState;
+
+// hid, pad
+typedef enum {
+    HidNpadIdType_No1 = 0,
+    HidNpadIdType_No2 = 1,
+    HidNpadIdType_No3 = 2,
+    HidNpadIdType_No4 = 3,
+    HidNpadIdType_No5 = 4,
+    HidNpadIdType_No6 = 5,
+    HidNpadIdType_No7 = 6,
+    HidNpadIdType_No8 = 7,
+    HidNpadIdType_Other = 0x10,
+    HidNpadIdType_Handheld = 0x20
+} HidNpadIdType;
+
+typedef enum {
+    HidNpadStyleTag_NpadFullKey = BIT(0),
+    HidNpadStyleTag_NpadHandheld = BIT(1),
+    HidNpadStyleTag_NpadJoyDual = BIT(2),
+    HidNpadStyleTag_NpadJoyLeft = BIT(3),
+    HidNpadStyleTag_NpadJoyRight = BIT(4)
+} HidNpadStyleTag;
+
+#define HidNpadStyleSet_NpadFullCtrl (HidNpadStyleTag_NpadFullKey | HidNpadStyleTag_NpadHandheld | HidNpadStyleTag_NpadJoyDual)
+#define HidNpadStyleSet_NpadStandard (HidNpadStyleSet_NpadFullCtrl | HidNpadStyleTag_NpadJoyLeft | HidNpadStyleTag_NpadJoyRight)
+
+typedef enum {
+    HidNpadButton_A = BIT(0),
+    HidNpadButton_B = BIT(1),
+    HidNpadButton_ZL = BIT(8),
+    HidNpadButton_ZR = BIT(9),
+    HidNpadButton_Plus = BIT(10),
+    HidNpadButton_Minus = BIT(11),
+    HidNpadButton_Left = BIT(12),
+    HidNpadButton_Up = BIT(13),
+    HidNpadButton_Right = BIT(14),
+    HidNpadButton_Down = BIT(15),
+    HidNpadButton_StickLLeft = BIT(16),
+    HidNpadButton_StickLUp = BIT(17),
+    HidNpadButton_StickLRight = BIT(18),
+    HidNpadButton_StickLDown = BIT(19),
+    HidNpadButton_StickRLeft = BIT(20),
+    HidNpadButton_StickRUp = BIT(21),
+    HidNpadButton_StickRRight = BIT(22),
+    HidNpadButton_StickRDown = BIT(23)
+} HidNpadButton;
+
+#define HidNpadButton_AnyLeft (HidNpadButton_Left | HidNpadButton_StickLLeft | HidNpadButton_StickRLeft)
+#define HidNpadButton_AnyUp (HidNpadButton_Up | HidNpadButton_StickLUp | HidNpadButton_StickRUp)
+#define HidNpadButton_AnyRight (HidNpadButton_Right | HidNpadButton_StickLRight | HidNpadButton_StickRRight)
+#define HidNpadButton_AnyDown (HidNpadButton_Down | HidNpadButton_StickLDown | HidNpadButton_StickRDown)
+
+typedef struct {
+    bool is_powered;
+    bool is_charging;
+    u8 reserved[6];
+    u32 battery_level;
+} HidPowerInfo;
+
+typedef struct {
+    u64 id;
+} HidsysUniquePadId;
+
+typedef struct {
+    u64 buttons_cur;
+    u64 buttons_old;
+} PadState;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool hosversionAtLeast(u8 major, u8 minor, u8 micro);
+bool hosversionBefore(u8 major, u8 minor, u8 micro);
+
+void eventClose(Event *t);
+Result eventClear(Event *t);
+void ueventCreate(UEvent *e, bool autoclear);
+void ueventSignal(UEvent *e);
+Waiter waiterForEvent(Event *t);
+Waiter waiterForUEvent(UEvent *e);
+Result waitObjects(s32 *idx_out, const Waiter *objects, s32 num_objects, u64 timeout);
+
+Result romfsInit(void);
+void romfsExit(void);
+Result socketInitializeDefault(void);
+void socketExit(void);
+int nxlinkStdio(void);
+
+Result setInitialize(void);
+void setExit(void);
+Result setGetSystemLanguage(u64 *out);
+Result setGetRegionCode(SetRegion *out);
+
+Result setsysInitialize(void);
+void setsysExit(void);
+Result setsysGetFirmwareVersion(SetSysFirmwareVersion *out);
+Result setsysGetSerialNumber(SetSysSerialNumber *out);
+Result setsysGetWirelessLanEnableFlag(bool *out);
+Result setsysGetBluetoothEnableFlag(bool *out);
+Result setsysGetNfcEnableFlag(bool *out);
+Result setsysGetAutoUpdateEnableFlag(bool *out);
+Result setsysGetConsoleInformationUploadFlag(bool *out);
+
+Result setcalInitialize(void);
+void setcalExit(void);
+Result setcalGetBdAddress(SetCalBdAddress *out);
+Result setcalGetWirelessLanMacAddress(SetCalMacAddress *out);
+Result setcalGetBatteryLot(SetBatteryLot *out);
+
+Result splInitialize(void);
+void splExit(void);
+Result splGetConfig(SplConfigItem config_item, u64 *out_config);
+
+Result nifmInitialize(NifmServiceType service_type);
+void nifmExit(void);
+
+Result appletInitialize(void);
+void appletExit(void);
+bool appletMainLoop(void);
+AppletOperationMode appletGetOperationMode(void);
+AppletFocusState appletGetFocusState(void);
+
+Result apmInitialize(void);
+void apmExit(void);
+
+Result nsInitialize(void);
+void nsExit(void);
+Result nsGetTotalSpaceSize(NcmStorageId storage_id, s64 *size);
+Result nsGetFreeSpaceSize(NcmStorageId storage_id, s64 *size);
+
+Result psmInitialize(void);
+void psmExit(void);
+Service *psmGetServiceSession(void);
+Result psmGetBatteryChargePercentage(u32 *out);
+Result psmGetChargerType(PsmChargerType *out);
+Result psmGetBatteryVoltageState(PsmBatteryVoltageState *out);
+Result psmGetRawBatteryChargePercentage(double *out);
+Result psmIsEnoughPowerSupplied(bool *out);
+Result psmGetBatteryAgePercentage(double *out);
+Result psmBindStateChangeEvent(PsmSession *s, bool ChargerType, bool PowerSupply, bool BatteryVoltage);
+Result psmUnbindStateChangeEvent(PsmSession *s);
+
+Result clkrstInitialize(void);
+void clkrstExit(void);
+Result clkrstOpenSession(ClkrstSession *session_out, PcvModuleId module_id, u32 unk);
+void clkrstCloseSession(ClkrstSession *session);
+Result clkrstGetClockRate(ClkrstSession *session, u32 *out_hz);
+
+Result pcvInitialize(void);
+void pcvExit(void);
+Result pcvGetModuleId(PcvModuleId *module_id, PcvModule module);
+Result pcvGetClockRate(PcvModule module, u32 *out_hz);
+
+Result wlaninfInitialize(void);
+void wlaninfExit(void);
+Result wlaninfGetState(WlanInfState *out);
+Result wlaninfGetRSSI(s32 *out);
+
+Result fsOpenDeviceOperator(FsDeviceOperator *out);
+void fsDeviceOperatorClose(FsDeviceOperator *d);
+Result fsDeviceOperatorIsSdCardInserted(FsDeviceOperator *d, bool *out);
+Result fsDeviceOperatorIsGameCardInserted(FsDeviceOperator *d, bool *out);
+Result fsOpenSdCardDetectionEventNotifier(FsEventNotifier *out);
+Result fsOpenGameCardDetectionEventNotifier(FsEventNotifier *out);
+Result fsEventNotifierGetEventHandle(FsEventNotifier *e, Event *out, bool autoclear);
+void fsEventNotifierClose(FsEventNotifier *e);
+
+Service *hiddbgGetServiceSession(void);
+u32 hidGetNpadStyleSet(HidNpadIdType id);
+void hidGetNpadPowerInfoSingle(HidNpadIdType id, HidPowerInfo *info);
+void hidGetNpadPowerInfoSplit(HidNpadIdType id, HidPowerInfo *info_left, HidPowerInfo *info_right);
+
+void padConfigureInput(u32 max_players, u32 style_set);
+void padInitializeDefault(PadState *pad);
+void padUpdate(PadState *pad);
+u64 padGetButtons(const PadState *pad);
+u64 padGetButtonsDown(const PadState *pad);
+bool padIsHandheld(const PadState *pad);
+
+// Raw IPC for commands libnx has no wrapper for.
+Result fakeServiceDispatch(Service *s, u32 request_id, const void *in, size_t in_size, void *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+
+template<typename Out>
+static inline Result serviceDispatchOut(Service *s, u32 request_id, Out &out) {
+    return fakeServiceDispatch(s, request_id, nullptr, 0, &out, sizeof(out));
+}
+
+template<typename In, typename Out>
+static inline Result serviceDispatchInOut(Service *s, u32 request_id, const In &in, Out &out) {
+    return fakeServiceDispatch(s, request_id, &in, sizeof(in), &out, sizeof(out));
+}
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <SDL.h>
+
+#include "bench.hpp"
+#include "fake_backend.hpp"
+
+using FakeBackend::GetConfig;
+
+namespace Bench {
+    static const u32 MaxPages = 16;
+
+    struct Page {
+        std::vector<u64> frame_ns;
+        bool captured;
+        u64 hash;
+        bool has_golden;
+        u64 golden;
+    };
+
+    static Page g_pages[MaxPages];
+
+    static u32 GetPage(u64 frame) {
+        const FakeBackend::Config *config = GetConfig();
+        u64 interval = config->page_interval, count = std::min<u64>(std::max<u64>(config->page_count, 1), MaxPages);
+        return (interval == 0)? 0 : static_cast<u32>((frame / interval) % count);
+    }
+
+    // FNV-1a over the frame's pixels.
+    static u64 HashPixels(const u8 *pixels, size_t size) {
+        u64 hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ pixels[i]) * 0x100000001B3ULL;
+
+        return hash;
+    }
+
+    // Hashes what the last frame presented, writing it to bench_page<N>.bmp as well if `save` is set. The app
+    // creates exactly one window, which is the first id SDL hands out.
+    static bool CaptureFramebuffer(u32 page, bool save, u64 *hash) {
+        SDL_Renderer *renderer = SDL_GetRenderer(SDL_GetWindowFromID(1));
+        int width = 0, height = 0;
+        if ((renderer == nullptr) || (SDL_GetRendererOutputSize(renderer, &width, &height) != 0))
+            return false;
+
+        std::vector<u8> pixels(static_cast<size_t>(width) * height * 4);
+        if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, pixels.data(), width * 4) != 0)
+            return false;
+
+        *hash = Bench::HashPixels(pixels.data(), pixels.size());
+
+        if (save) {
+            char path[32];
+            std::snprintf(path, sizeof(path), "bench_page%u.bmp", page);
+            SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels.data(), width, height, 32, width * 4, SDL_PIXELFORMAT_ARGB8888);
+            if (surface != nullptr) {
+                SDL_SaveBMP(surface, path);
+                SDL_FreeSurface(surface);
+            }
+        }
+
+        return true;
+    }
+
+    static bool LoadGolden(const char *path) {
+        FILE *file = std::fopen(path, "r");
+        if (file == nullptr)
+            return false;
+
+        char line[128];
+        while (std::fgets(line, sizeof(line), file)) {
+            unsigned int page = 0;
+            unsigned long long hash = 0;
+
+            if ((line[0] == '#') || (std::sscanf(line, "%u %llx", &page, &hash) != 2) || (page >= MaxPages))
+                continue;
+
+            g_pages[page].has_golden = true;
+            g_pages[page].golden = hash;
+        }
+
+        std::fclose(file);
+        return true;
+    }
+
+    static void SaveGolden(const char *path) {
+        FILE *file = std::fopen(path, "w");
+        if (file == nullptr) {
+            std::printf("bench: could not write %s\n", path);
+            return;
+        }
+
+        std::fprintf(file, "# page framebuffer-hash, recorded by the host bench (see host/bench.ini)\n");
+        for (u32 i = 0; i < MaxPages; i++) {
+            if (g_pages[i].has_golden)
+                std::fprintf(file, "%u %016llx\n", i, static_cast<unsigned long long>(g_pages[i].golden));
+        }
+
+        std::fclose(file);
+    }
+
+    void EndFrame(u64 frame, u64 elapsed_ns) {
+        const FakeBackend::Config *config = GetConfig();
+        u32 page = Bench::GetPage(frame);
+        Page *entry = &g_pages[page];
+        entry->frame_ns.push_back(elapsed_ns);
+
+        // Each page is captured on the last frame of its first visit, once its data has had time to arrive.
+        u64 interval = config->page_interval;
+        if ((interval != 0) && !entry->captured && (((frame + 1) % interval) == 0) && (config->golden_pages & BIT(page)))
+            entry->captured = Bench::CaptureFramebuffer(page, true, &entry->hash);
+    }
+
+    bool Finish(void) {
+        const FakeBackend::Config *config = GetConfig();
+        bool checked = config->golden_path[0] != '\0', record = checked && config->golden_record, passed = true;
+
+        // Outside of record mode a missing golden file is a failure, not something to fill in quietly.
+        if (checked && !record && !Bench::LoadGolden(config->golden_path)) {
+            std::printf("bench: could not read %s; record it with `make -C host golden`\n", config->golden_path);
+            passed = false;
+        }
+
+        std::printf("page  frames   mean us    p99 us  golden\n");
+        for (u32 i = 0; i < MaxPages; i++) {
+            Page *page = &g_pages[i];
+            if (page->frame_ns.empty()) {
+                // A checked page the run never reached proves nothing either way.
+                if (checked && (config->golden_pages & BIT(i)) && (i < config->page_count)) {
+                    std::printf("%4u  %6d  %8s  %8s  %s\n", i, 0, "-", "-", "NOT CAPTURED");
+                    passed = false;
+                }
+
+                continue;
+            }
+
+            std::vector<u64> sorted = page->frame_ns;
+            std::sort(sorted.begin(), sorted.end());
+
+            u64 total = 0;
+            for (u64 ns : sorted)
+                total += ns;
+
+            const char *result = "-";
+            if (checked && (config->golden_pages & BIT(i))) {
+                if (!page->captured) {
+                    passed = false;
+                    result = "NOT CAPTURED";
+                }
+                else if (record) {
+                    page->has_golden = true;
+                    page->golden = page->hash;
+                    result = "recorded";
+                }
+                else if (!page->has_golden) {
+                    passed = false;
+                    result = "MISSING";
+                }
+                else if (page->golden == page->hash)
+                    result = "ok";
+                else {
+                    passed = false;
+                    result = "MISMATCH";
+                }
+            }
+
+            std::printf("%4u  %6zu  %8llu  %8llu  %s\n", i, sorted.size(), static_cast<unsigned long long>(total / sorted.size() / 1000),
+                static_cast<unsigned long long>(sorted[((sorted.size() * 99) + 99) / 100 - 1] / 1000), result);
+        }
+
+        if (record && passed)
+            Bench::SaveGolden(config->golden_path);
+
+        if (!passed)
+            std::printf("bench: framebuffer check against %s failed, see bench_page<N>.bmp\n", config->golden_path);
+
+        return passed;
+    }
+}
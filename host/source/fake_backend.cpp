@@ -0,0 +1,277 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "fake_backend.hpp"
+
+namespace FakeBackend {
+    static const char *g_service_names[FakeService_Count] = {
+        "romfs", "socket", "set", "setsys", "setcal", "spl", "nifm", "applet",
+        "apm", "ns", "psm", "clkrst", "pcv", "wlaninf", "fs", "hid"
+    };
+
+    static void CopyString(char *dst, size_t size, const char *src) {
+        std::snprintf(dst, size, "%s", src);
+    }
+
+    static void SetDefaults(Config *config) {
+        std::memset(config, 0, sizeof(Config));
+
+        config->hos_version[0] = 17;
+        config->firmware_version.major = 17;
+        std::snprintf(config->firmware_version.display_version, sizeof(config->firmware_version.display_version), "17.0.0");
+        std::snprintf(config->serial_number.number, sizeof(config->serial_number.number), "XAW10000000000");
+        std::snprintf(config->battery_lot.lot, sizeof(config->battery_lot.lot), "FAKEBATTERYLOT");
+
+        for (int i = 0; i < 6; i++) {
+            config->bd_addr.bd_addr[i] = 0x10 + i;
+            config->mac_addr.addr[i] = 0x20 + i;
+        }
+
+        config->hardware_type = 0;
+        config->dram_id = 0;
+        config->device_id = 0x0123456789ABCDEFULL;
+        config->is_retail = true;
+        config->region = SetRegion_EUR;
+        config->cpu_clock = 1020000000;
+        config->gpu_clock = 768000000;
+        config->emc_clock = 1600000000;
+        config->wlan_enabled = true;
+        config->bluetooth_enabled = true;
+        config->auto_update_enabled = true;
+        config->wlan_rssi = -55;
+        config->battery_percentage = 87;
+        config->charger_type = PsmChargerType_EnoughPower;
+        config->voltage_state = PsmBatteryVoltageState_Normal;
+        config->charging_enabled = true;
+        config->enough_power_supplied = true;
+        config->operation_mode = AppletOperationMode_Console;
+        config->sd_inserted = true;
+
+        config->total_space[NcmStorageId_SdCard] = 128LL << 30;
+        config->free_space[NcmStorageId_SdCard] = 71LL << 30;
+        config->total_space[NcmStorageId_BuiltInUser] = 26LL << 30;
+        config->free_space[NcmStorageId_BuiltInUser] = 19LL << 30;
+        config->total_space[NcmStorageId_BuiltInSystem] = 2LL << 30;
+        config->free_space[NcmStorageId_BuiltInSystem] = 1LL << 30;
+
+        config->npad_style_sets[1] = HidNpadStyleTag_NpadJoyDual;
+        config->npad_battery_level = 3;
+
+        std::snprintf(config->ip_address, sizeof(config->ip_address), "192.168.1.20");
+
+        config->page_interval = 120;
+        std::snprintf(config->stats_path, sizeof(config->stats_path), "SwitchIdent_host_stats.csv");
+        config->page_count = 8;
+        config->golden_pages = 0xBF; // Everything but the diagnostics page, which shows live timings.
+    }
+
+    static bool ParseStorage(const char *key, const char *value, Config *config) {
+        static const struct { const char *name; NcmStorageId id; } storages[] = {
+            { "sd", NcmStorageId_SdCard },
+            { "user", NcmStorageId_BuiltInUser },
+            { "system", NcmStorageId_BuiltInSystem },
+            { "gamecard", NcmStorageId_GameCard }
+        };
+
+        for (auto &storage : storages) {
+            char total_key[32], free_key[32];
+            std::snprintf(total_key, sizeof(total_key), "%s_total", storage.name);
+            std::snprintf(free_key, sizeof(free_key), "%s_free", storage.name);
+
+            if (std::strcmp(key, total_key) == 0)
+                config->total_space[storage.id] = std::strtoll(value, nullptr, 0);
+            else if (std::strcmp(key, free_key) == 0)
+                config->free_space[storage.id] = std::strtoll(value, nullptr, 0);
+            else
+                continue;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    static void ParseValue(const char *key, const char *value, Config *config) {
+        u64 number = std::strtoull(value, nullptr, 0);
+
+        if (std::strncmp(key, "latency_us.", 11) == 0) {
+            for (int i = 0; i < FakeService_Count; i++) {
+                if (std::strcmp(key + 11, g_service_names[i]) == 0) {
+                    config->latency_us[i] = number;
+                    return;
+                }
+            }
+        }
+        else if (std::strncmp(key, "latency_jitter_us.", 18) == 0) {
+            for (int i = 0; i < FakeService_Count; i++) {
+                if (std::strcmp(key + 18, g_service_names[i]) == 0) {
+                    config->latency_jitter_us[i] = number;
+                    return;
+                }
+            }
+        }
+        else if (std::strcmp(key, "firmware_version") == 0) {
+            unsigned int major = 0, minor = 0, micro = 0;
+            std::sscanf(value, "%u.%u.%u", &major, &minor, &micro);
+            config->firmware_version.major = config->hos_version[0] = major;
+            config->firmware_version.minor = config->hos_version[1] = minor;
+            config->firmware_version.micro = config->hos_version[2] = micro;
+            FakeBackend::CopyString(config->firmware_version.display_version, sizeof(config->firmware_version.display_version), value);
+            return;
+        }
+        else if (std::strcmp(key, "serial_number") == 0) {
+            FakeBackend::CopyString(config->serial_number.number, sizeof(config->serial_number.number), value);
+            return;
+        }
+        else if (std::strcmp(key, "battery_lot") == 0) {
+            FakeBackend::CopyString(config->battery_lot.lot, sizeof(config->battery_lot.lot), value);
+            return;
+        }
+        else if (std::strcmp(key, "stats_path") == 0) {
+            FakeBackend::CopyString(config->stats_path, sizeof(config->stats_path), value);
+            return;
+        }
+        else if (std::strcmp(key, "golden_path") == 0) {
+            FakeBackend::CopyString(config->golden_path, sizeof(config->golden_path), value);
+            return;
+        }
+        else if (std::strcmp(key, "ip_address") == 0) {
+            FakeBackend::CopyString(config->ip_address, sizeof(config->ip_address), value);
+            return;
+        }
+        else if (FakeBackend::ParseStorage(key, value, config))
+            return;
+
+        static const struct { const char *name; void (*set)(Config *, u64); } numbers[] = {
+            { "hardware_type", [](Config *c, u64 v) { c->hardware_type = v; } },
+            { "dram_id", [](Config *c, u64 v) { c->dram_id = v; } },
+            { "device_id", [](Config *c, u64 v) { c->device_id = v; } },
+            { "is_retail", [](Config *c, u64 v) { c->is_retail = v; } },
+            { "region", [](Config *c, u64 v) { c->region = static_cast<SetRegion>(v); } },
+            { "language", [](Config *c, u64 v) { c->language = v; } },
+            { "cpu_clock", [](Config *c, u64 v) { c->cpu_clock = v; } },
+            { "gpu_clock", [](Config *c, u64 v) { c->gpu_clock = v; } },
+            { "emc_clock", [](Config *c, u64 v) { c->emc_clock = v; } },
+            { "wlan_enabled", [](Config *c, u64 v) { c->wlan_enabled = v; } },
+            { "bluetooth_enabled", [](Config *c, u64 v) { c->bluetooth_enabled = v; } },
+            { "nfc_enabled", [](Config *c, u64 v) { c->nfc_enabled = v; } },
+            { "auto_update_enabled", [](Config *c, u64 v) { c->auto_update_enabled = v; } },
+            { "console_info_upload_enabled", [](Config *c, u64 v) { c->console_info_upload_enabled = v; } },
+            { "battery_percentage", [](Config *c, u64 v) { c->battery_percentage = v; } },
+            { "charger_type", [](Config *c, u64 v) { c->charger_type = static_cast<PsmChargerType>(v); } },
+            { "voltage_state", [](Config *c, u64 v) { c->voltage_state = static_cast<PsmBatteryVoltageState>(v); } },
+            { "charging_enabled", [](Config *c, u64 v) { c->charging_enabled = v; } },
+            { "enough_power_supplied", [](Config *c, u64 v) { c->enough_power_supplied = v; } },
+            { "operation_mode", [](Config *c, u64 v) { c->operation_mode = static_cast<AppletOperationMode>(v); } },
+            { "sd_inserted", [](Config *c, u64 v) { c->sd_inserted = v; } },
+            { "gamecard_inserted", [](Config *c, u64 v) { c->gamecard_inserted = v; } },
+            { "npad_battery_level", [](Config *c, u64 v) { c->npad_battery_level = v; } },
+            { "event_interval_ms", [](Config *c, u64 v) { c->event_interval_ms = v; } },
+            { "max_frames", [](Config *c, u64 v) { c->max_frames = v; } },
+            { "page_interval", [](Config *c, u64 v) { c->page_interval = v; } },
+            { "background_at_frame", [](Config *c, u64 v) { c->background_at_frame = v; } },
+            { "background_frames", [](Config *c, u64 v) { c->background_frames = v; } },
+            { "bench", [](Config *c, u64 v) { c->bench = v; } },
+            { "page_count", [](Config *c, u64 v) { c->page_count = v; } },
+            { "golden_pages", [](Config *c, u64 v) { c->golden_pages = v; } },
+            { "golden_record", [](Config *c, u64 v) { c->golden_record = v; } },
+            { "seed", [](Config *c, u64 v) { c->seed = v; } },
+        };
+
+        for (auto &entry : numbers) {
+            if (std::strcmp(key, entry.name) == 0) {
+                entry.set(config, number);
+                return;
+            }
+        }
+
+        // wlan_rssi is signed, and the npad style sets are indexed.
+        if (std::strcmp(key, "wlan_rssi") == 0)
+            config->wlan_rssi = std::strtol(value, nullptr, 0);
+        else if (std::strcmp(key, "npad_style.handheld") == 0)
+            config->npad_style_sets[0] = number;
+        else if ((std::strncmp(key, "npad_style.", 11) == 0) && (key[11] >= '1') && (key[11] <= '8') && (key[12] == '\0'))
+            config->npad_style_sets[key[11] - '0'] = number;
+        else
+            std::printf("fake backend: unknown key '%s'\n", key);
+    }
+
+    static void LoadConfig(Config *config, const char *path) {
+        FILE *file = std::fopen(path, "r");
+        if (file == nullptr) {
+            std::printf("fake backend: could not open %s, using defaults\n", path);
+            return;
+        }
+
+        char line[512];
+        while (std::fgets(line, sizeof(line), file)) {
+            char *comment = std::strchr(line, '#');
+            if (comment != nullptr)
+                *comment = '\0';
+
+            char key[128], value[256];
+            if (std::sscanf(line, " %127[^= \t] = %255[^\r\n]", key, value) != 2)
+                continue;
+
+            // Trailing whitespace before a comment is not part of the value.
+            for (size_t len = std::strlen(value); (len > 0) && ((value[len - 1] == ' ') || (value[len - 1] == '\t')); len--)
+                value[len - 1] = '\0';
+
+            // `include = <file>` reads another config at this point; relative paths are taken from this file's directory.
+            if (std::strcmp(key, "include") == 0) {
+                const char *slash = std::strrchr(path, '/');
+                int dir_len = ((value[0] != '/') && (slash != nullptr))? static_cast<int>(slash - path + 1) : 0;
+
+                char include_path[512];
+                std::snprintf(include_path, sizeof(include_path), "%.*s%s", dir_len, path, value);
+                FakeBackend::LoadConfig(config, include_path);
+                continue;
+            }
+
+            FakeBackend::ParseValue(key, value, config);
+        }
+
+        std::fclose(file);
+    }
+
+    const Config *GetConfig(void) {
+        static const Config config = [] {
+            Config config;
+            FakeBackend::SetDefaults(&config);
+
+            const char *path = std::getenv("SWITCHIDENT_FAKE_CONFIG");
+            if (path != nullptr)
+                FakeBackend::LoadConfig(&config, path);
+
+            return config;
+        }();
+
+        return &config;
+    }
+
+    // One generator for every thread, so a seed reproduces the same sequence of delays; which thread draws
+    // which of them still depends on scheduling.
+    static u64 GetJitter(u64 range_us) {
+        static std::mutex mutex;
+        static std::mt19937_64 generator(FakeBackend::GetConfig()->seed);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return generator() % (range_us + 1);
+    }
+
+    void Call(FakeService service) {
+        const Config *config = FakeBackend::GetConfig();
+        u64 latency_us = config->latency_us[service];
+
+        if (config->latency_jitter_us[service] != 0)
+            latency_us += FakeBackend::GetJitter(config->latency_jitter_us[service]);
+
+        if (latency_us != 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(latency_us));
+    }
+}
@@ -0,0 +1,529 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <SDL.h>
+
+#include "bench.hpp"
+#include "fake_backend.hpp"
+#include "stats.hpp"
+
+using FakeBackend::Call;
+using FakeBackend::GetConfig;
+
+// Events, user events and waiters share one table of signal flags guarded by a single mutex.
+namespace {
+    const int MaxHandles = 64;
+
+    std::mutex g_sync_mutex;
+    std::condition_variable g_sync_cond;
+    bool g_signaled[MaxHandles];
+    Handle g_next_handle = 1;
+
+    Handle CreateHandle(void) {
+        std::lock_guard<std::mutex> lock(g_sync_mutex);
+        if (g_next_handle >= MaxHandles)
+            return INVALID_HANDLE;
+
+        return g_next_handle++;
+    }
+
+    void Signal(Handle handle) {
+        {
+            std::lock_guard<std::mutex> lock(g_sync_mutex);
+            g_signaled[handle] = true;
+        }
+
+        g_sync_cond.notify_all();
+    }
+
+    Service g_psm_service = { 1 };
+    Service g_hiddbg_service = { 2 };
+    u64 g_frame = 0;
+    u64 g_last_frame_ns = 0;
+    u64 g_frame_start_ns = 0;
+}
+
+extern "C" {
+
+bool hosversionAtLeast(u8 major, u8 minor, u8 micro) {
+    const u8 *version = GetConfig()->hos_version;
+    return ((version[0] << 16) | (version[1] << 8) | version[2]) >= ((major << 16) | (minor << 8) | micro);
+}
+
+bool hosversionBefore(u8 major, u8 minor, u8 micro) {
+    return !hosversionAtLeast(major, minor, micro);
+}
+
+void eventClose(Event *t) {
+    t->revent = INVALID_HANDLE;
+}
+
+Result eventClear(Event *t) {
+    std::lock_guard<std::mutex> lock(g_sync_mutex);
+    g_signaled[t->revent] = false;
+    return 0;
+}
+
+void ueventCreate(UEvent *e, bool autoclear) {
+    e->handle = CreateHandle();
+    e->autoclear = autoclear;
+}
+
+void ueventSignal(UEvent *e) {
+    Signal(e->handle);
+}
+
+Waiter waiterForEvent(Event *t) {
+    Waiter waiter = { WaiterType_Handle, t->revent, nullptr };
+    return waiter;
+}
+
+Waiter waiterForUEvent(UEvent *e) {
+    Waiter waiter = { WaiterType_UEvent, e->handle, e };
+    return waiter;
+}
+
+// Kernel events (psm, fs) all fire together every `event_interval_ms`, as if the charger and both card slots changed.
+Result waitObjects(s32 *idx_out, const Waiter *objects, s32 num_objects, u64 timeout) {
+    u64 interval_ms = GetConfig()->event_interval_ms;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout == UINT64_MAX? (1ULL << 62) : timeout);
+    std::unique_lock<std::mutex> lock(g_sync_mutex);
+
+    while (true) {
+        for (s32 i = 0; i < num_objects; i++) {
+            if (g_signaled[objects[i].handle]) {
+                if ((objects[i].type == WaiterType_UEvent) && objects[i].event->autoclear)
+                    g_signaled[objects[i].handle] = false;
+
+                *idx_out = i;
+                return 0;
+            }
+        }
+
+        auto wake = deadline;
+        if (interval_ms != 0)
+            wake = std::min(wake, std::chrono::steady_clock::now() + std::chrono::milliseconds(interval_ms));
+
+        if ((g_sync_cond.wait_until(lock, wake) == std::cv_status::timeout) && (wake != deadline)) {
+            for (s32 i = 0; i < num_objects; i++) {
+                if (objects[i].type == WaiterType_Handle)
+                    g_signaled[objects[i].handle] = true;
+            }
+        }
+        else if (std::chrono::steady_clock::now() >= deadline)
+            return 0xEA01; // KernelError_TimedOut
+    }
+}
+
+Result romfsInit(void) { Call(FakeBackend::FakeService_Romfs); return 0; }
+void romfsExit(void) {}
+Result socketInitializeDefault(void) { Call(FakeBackend::FakeService_Socket); return 0; }
+void socketExit(void) {}
+int nxlinkStdio(void) { return -1; }
+
+Result setInitialize(void) { Call(FakeBackend::FakeService_Set); return 0; }
+void setExit(void) {}
+
+Result setGetSystemLanguage(u64 *out) {
+    Call(FakeBackend::FakeService_Set);
+    *out = GetConfig()->language;
+    return 0;
+}
+
+Result setGetRegionCode(SetRegion *out) {
+    Call(FakeBackend::FakeService_Set);
+    *out = GetConfig()->region;
+    return 0;
+}
+
+Result setsysInitialize(void) { Call(FakeBackend::FakeService_SetSys); return 0; }
+void setsysExit(void) {}
+
+Result setsysGetFirmwareVersion(SetSysFirmwareVersion *out) {
+    Call(FakeBackend::FakeService_SetSys);
+    *out = GetConfig()->firmware_version;
+    return 0;
+}
+
+Result setsysGetSerialNumber(SetSysSerialNumber *out) {
+    Call(FakeBackend::FakeService_SetSys);
+    *out = GetConfig()->serial_number;
+    return 0;
+}
+
+static Result GetSetSysFlag(bool value, bool *out) {
+    Call(FakeBackend::FakeService_SetSys);
+    *out = value;
+    return 0;
+}
+
+Result setsysGetWirelessLanEnableFlag(bool *out) { return GetSetSysFlag(GetConfig()->wlan_enabled, out); }
+Result setsysGetBluetoothEnableFlag(bool *out) { return GetSetSysFlag(GetConfig()->bluetooth_enabled, out); }
+Result setsysGetNfcEnableFlag(bool *out) { return GetSetSysFlag(GetConfig()->nfc_enabled, out); }
+Result setsysGetAutoUpdateEnableFlag(bool *out) { return GetSetSysFlag(GetConfig()->auto_update_enabled, out); }
+Result setsysGetConsoleInformationUploadFlag(bool *out) { return GetSetSysFlag(GetConfig()->console_info_upload_enabled, out); }
+
+Result setcalInitialize(void) { Call(FakeBackend::FakeService_SetCal); return 0; }
+void setcalExit(void) {}
+
+Result setcalGetBdAddress(SetCalBdAddress *out) {
+    Call(FakeBackend::FakeService_SetCal);
+    *out = GetConfig()->bd_addr;
+    return 0;
+}
+
+Result setcalGetWirelessLanMacAddress(SetCalMacAddress *out) {
+    Call(FakeBackend::FakeService_SetCal);
+    *out = GetConfig()->mac_addr;
+    return 0;
+}
+
+Result setcalGetBatteryLot(SetBatteryLot *out) {
+    Call(FakeBackend::FakeService_SetCal);
+    *out = GetConfig()->battery_lot;
+    return 0;
+}
+
+Result splInitialize(void) { Call(FakeBackend::FakeService_Spl); return 0; }
+void splExit(void) {}
+
+Result splGetConfig(SplConfigItem config_item, u64 *out_config) {
+    const FakeBackend::Config *config = GetConfig();
+    Call(FakeBackend::FakeService_Spl);
+
+    switch (config_item) {
+        case SplConfigItem_DramId:
+            *out_config = config->dram_id;
+            break;
+
+        case SplConfigItem_HardwareType:
+            *out_config = config->hardware_type;
+            break;
+
+        case SplConfigItem_IsRetail:
+            *out_config = config->is_retail;
+            break;
+
+        case SplConfigItem_DeviceId:
+            *out_config = config->device_id;
+            break;
+
+        default:
+            *out_config = 0;
+            break;
+    }
+
+    return 0;
+}
+
+Result nifmInitialize(NifmServiceType service_type) { Call(FakeBackend::FakeService_Nifm); return 0; }
+void nifmExit(void) {}
+
+// On the console gethostname() reports the IP address nifm assigned; report the configured one rather than the
+// build machine's name so the misc page renders the same everywhere.
+int gethostname(char *name, size_t len) {
+    Call(FakeBackend::FakeService_Nifm);
+    std::snprintf(name, len, "%s", GetConfig()->ip_address);
+    return 0;
+}
+
+Result appletInitialize(void) { Call(FakeBackend::FakeService_Applet); return 0; }
+void appletExit(void) {}
+
+// One call per frame: records the frame time, stops after `max_frames` or when the window is closed, and dumps
+// the call statistics on the way out.
+bool appletMainLoop(void) {
+    const FakeBackend::Config *config = GetConfig();
+    static Stats::Counter *counter = Stats::GetCounter("frame");
+    u64 now = Stats::GetTimeNs();
+
+    if (g_last_frame_ns != 0)
+        Stats::Record(counter, now - g_last_frame_ns, 0);
+
+    g_last_frame_ns = now;
+
+    if (config->bench && (g_frame != 0))
+        Bench::EndFrame(g_frame, now - g_frame_start_ns);
+
+    if (((config->max_frames != 0) && (g_frame >= config->max_frames)) || SDL_QuitRequested()) {
+        std::printf("%llu frames, p50 %llu us, p99 %llu us, max %llu us\n", (unsigned long long)g_frame,
+            (unsigned long long)(Stats::GetPercentile(counter, 50) / 1000), (unsigned long long)(Stats::GetPercentile(counter, 99) / 1000),
+            (unsigned long long)(counter->max_ns.load() / 1000));
+        Stats::Dump(config->stats_path);
+
+        // A golden-image mismatch has to reach the caller's exit status; nothing after this point is being measured.
+        if (config->bench && !Bench::Finish()) {
+            std::fflush(stdout);
+            std::_Exit(1);
+        }
+
+        return false;
+    }
+
+    g_frame++;
+    g_frame_start_ns = Stats::GetTimeNs();
+    return true;
+}
+
+AppletOperationMode appletGetOperationMode(void) {
+    return GetConfig()->operation_mode;
+}
+
+AppletFocusState appletGetFocusState(void) {
+    const FakeBackend::Config *config = GetConfig();
+
+    if ((config->background_at_frame != 0) && (g_frame >= config->background_at_frame) && (g_frame < config->background_at_frame + config->background_frames))
+        return AppletFocusState_Background;
+
+    return AppletFocusState_InFocus;
+}
+
+Result apmInitialize(void) { Call(FakeBackend::FakeService_Apm); return 0; }
+void apmExit(void) {}
+
+Result nsInitialize(void) { Call(FakeBackend::FakeService_Ns); return 0; }
+void nsExit(void) {}
+
+Result nsGetTotalSpaceSize(NcmStorageId storage_id, s64 *size) {
+    Call(FakeBackend::FakeService_Ns);
+    *size = GetConfig()->total_space[storage_id];
+    return 0;
+}
+
+Result nsGetFreeSpaceSize(NcmStorageId storage_id, s64 *size) {
+    Call(FakeBackend::FakeService_Ns);
+    *size = GetConfig()->free_space[storage_id];
+    return 0;
+}
+
+Result psmInitialize(void) { Call(FakeBackend::FakeService_Psm); return 0; }
+void psmExit(void) {}
+
+Service *psmGetServiceSession(void) {
+    return &g_psm_service;
+}
+
+Result psmGetBatteryChargePercentage(u32 *out) {
+    Call(FakeBackend::FakeService_Psm);
+    *out = GetConfig()->battery_percentage;
+    return 0;
+}
+
+Result psmGetChargerType(PsmChargerType *out) {
+    Call(FakeBackend::FakeService_Psm);
+    *out = GetConfig()->charger_type;
+    return 0;
+}
+
+Result psmGetBatteryVoltageState(PsmBatteryVoltageState *out) {
+    Call(FakeBackend::FakeService_Psm);
+    *out = GetConfig()->voltage_state;
+    return 0;
+}
+
+Result psmGetRawBatteryChargePercentage(double *out) {
+    Call(FakeBackend::FakeService_Psm);
+    *out = GetConfig()->battery_percentage;
+    return 0;
+}
+
+Result psmIsEnoughPowerSupplied(bool *out) {
+    Call(FakeBackend::FakeService_Psm);
+    *out = GetConfig()->enough_power_supplied;
+    return 0;
+}
+
+Result psmGetBatteryAgePercentage(double *out) {
+    Call(FakeBackend::FakeService_Psm);
+    *out = 100.0;
+    return 0;
+}
+
+Result psmBindStateChangeEvent(PsmSession *s, bool ChargerType, bool PowerSupply, bool BatteryVoltage) {
+    Call(FakeBackend::FakeService_Psm);
+    s->StateChangeEvent.revent = CreateHandle();
+    s->StateChangeEvent.autoclear = true;
+    return 0;
+}
+
+Result psmUnbindStateChangeEvent(PsmSession *s) {
+    eventClose(&s->StateChangeEvent);
+    return 0;
+}
+
+Result clkrstInitialize(void) { Call(FakeBackend::FakeService_Clkrst); return 0; }
+void clkrstExit(void) {}
+
+Result clkrstOpenSession(ClkrstSession *session_out, PcvModuleId module_id, u32 unk) {
+    Call(FakeBackend::FakeService_Clkrst);
+    session_out->s.id = module_id;
+    return 0;
+}
+
+void clkrstCloseSession(ClkrstSession *session) {}
+
+static u32 GetClockRate(u32 module) {
+    const FakeBackend::Config *config = GetConfig();
+
+    switch (module) {
+        case PcvModule_CpuBus:
+            return config->cpu_clock;
+
+        case PcvModule_GPU:
+            return config->gpu_clock;
+
+        case PcvModule_EMC:
+            return config->emc_clock;
+    }
+
+    return 0;
+}
+
+Result clkrstGetClockRate(ClkrstSession *session, u32 *out_hz) {
+    Call(FakeBackend::FakeService_Clkrst);
+    *out_hz = GetClockRate(session->s.id);
+    return 0;
+}
+
+Result pcvInitialize(void) { Call(FakeBackend::FakeService_Pcv); return 0; }
+void pcvExit(void) {}
+
+// Module ids are passed through unchanged so clkrstGetClockRate() can map them back.
+Result pcvGetModuleId(PcvModuleId *module_id, PcvModule module) {
+    *module_id = module;
+    return 0;
+}
+
+Result pcvGetClockRate(PcvModule module, u32 *out_hz) {
+    Call(FakeBackend::FakeService_Pcv);
+    *out_hz = GetClockRate(module);
+    return 0;
+}
+
+Result wlaninfInitialize(void) { Call(FakeBackend::FakeService_WlanInf); return 0; }
+void wlaninfExit(void) {}
+
+Result wlaninfGetState(WlanInfState *out) {
+    Call(FakeBackend::FakeService_WlanInf);
+    *out = GetConfig()->wlan_enabled? WlanInfState_Connected : WlanInfState_NotInitialized;
+    return 0;
+}
+
+Result wlaninfGetRSSI(s32 *out) {
+    Call(FakeBackend::FakeService_WlanInf);
+    *out = GetConfig()->wlan_rssi;
+    return 0;
+}
+
+Result fsOpenDeviceOperator(FsDeviceOperator *out) {
+    Call(FakeBackend::FakeService_Fs);
+    return 0;
+}
+
+void fsDeviceOperatorClose(FsDeviceOperator *d) {}
+
+Result fsDeviceOperatorIsSdCardInserted(FsDeviceOperator *d, bool *out) {
+    Call(FakeBackend::FakeService_Fs);
+    *out = GetConfig()->sd_inserted;
+    return 0;
+}
+
+Result fsDeviceOperatorIsGameCardInserted(FsDeviceOperator *d, bool *out) {
+    Call(FakeBackend::FakeService_Fs);
+    *out = GetConfig()->gamecard_inserted;
+    return 0;
+}
+
+Result fsOpenSdCardDetectionEventNotifier(FsEventNotifier *out) {
+    Call(FakeBackend::FakeService_Fs);
+    return 0;
+}
+
+Result fsOpenGameCardDetectionEventNotifier(FsEventNotifier *out) {
+    Call(FakeBackend::FakeService_Fs);
+    return 0;
+}
+
+Result fsEventNotifierGetEventHandle(FsEventNotifier *e, Event *out, bool autoclear) {
+    Call(FakeBackend::FakeService_Fs);
+    out->revent = CreateHandle();
+    out->autoclear = autoclear;
+    return 0;
+}
+
+void fsEventNotifierClose(FsEventNotifier *e) {}
+
+Service *hiddbgGetServiceSession(void) {
+    return &g_hiddbg_service;
+}
+
+static int GetNpadIndex(HidNpadIdType id) {
+    return (id == HidNpadIdType_Handheld)? 0 : ((id <= HidNpadIdType_No8)? (id + 1) : -1);
+}
+
+u32 hidGetNpadStyleSet(HidNpadIdType id) {
+    int index = GetNpadIndex(id);
+    Call(FakeBackend::FakeService_Hid);
+    return (index < 0)? 0 : GetConfig()->npad_style_sets[index];
+}
+
+void hidGetNpadPowerInfoSingle(HidNpadIdType id, HidPowerInfo *info) {
+    Call(FakeBackend::FakeService_Hid);
+    std::memset(info, 0, sizeof(HidPowerInfo));
+    info->is_powered = true;
+    info->battery_level = GetConfig()->npad_battery_level;
+}
+
+void hidGetNpadPowerInfoSplit(HidNpadIdType id, HidPowerInfo *info_left, HidPowerInfo *info_right) {
+    hidGetNpadPowerInfoSingle(id, info_left);
+    hidGetNpadPowerInfoSingle(id, info_right);
+}
+
+void padConfigureInput(u32 max_players, u32 style_set) {}
+
+void padInitializeDefault(PadState *pad) {
+    std::memset(pad, 0, sizeof(PadState));
+}
+
+// Scripted input: "down" is pressed every `page_interval` frames so a run visits every page in turn.
+void padUpdate(PadState *pad) {
+    u64 interval = GetConfig()->page_interval;
+
+    pad->buttons_old = pad->buttons_cur;
+    pad->buttons_cur = ((interval != 0) && (g_frame != 0) && ((g_frame % interval) == 0))? HidNpadButton_Down : 0;
+
+    // The menu only redraws on input or new data; in bench mode a fresh press of a button it ignores lands every
+    // frame, so every frame is drawn.
+    if (GetConfig()->bench)
+        pad->buttons_cur |= (g_frame & 1)? HidNpadButton_ZL : HidNpadButton_ZR;
+}
+
+u64 padGetButtons(const PadState *pad) {
+    return pad->buttons_cur;
+}
+
+u64 padGetButtonsDown(const PadState *pad) {
+    return pad->buttons_cur & ~pad->buttons_old;
+}
+
+bool padIsHandheld(const PadState *pad) {
+    return GetConfig()->npad_style_sets[0] != 0;
+}
+
+// psm cmd 4 (IsBatteryChargingEnabled) is the only raw command the app sends; hiddbg gets a failure.
+Result fakeServiceDispatch(Service *s, u32 request_id, const void *in, size_t in_size, void *out, size_t out_size) {
+    std::memset(out, 0, out_size);
+
+    if ((s == &g_psm_service) && (request_id == 4)) {
+        Call(FakeBackend::FakeService_Psm);
+        *static_cast<u8 *>(out) = GetConfig()->charging_enabled;
+        return 0;
+    }
+
+    return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+}
+
+}
@@ -0,0 +1,326 @@
+// Checks and microbenchmarks for source/SDL_FontCache.c.  The file is included whole so that its static helpers can
+// be called directly.
+//
+//   fontcache          run the checks; exits non-zero on the first failure
+//   fontcache bench    time the hot helpers
+#include "SDL_FontCache.c"
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define FC_CHECK(cond, ...) do { if(!(cond)) { printf("FAILED: " __VA_ARGS__); printf("\n"); ++failures; } } while(0)
+
+static double FC_TestNow(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// The packed UTF-8 key FC_GetCodepointFromUTF8() produces for a scalar value
+static Uint32 FC_TestPack(Uint32 scalar)
+{
+    if(scalar < 0x80)
+        return scalar;
+    if(scalar < 0x800)
+        return ((0xC0 | (scalar >> 6)) << 8) | (0x80 | (scalar & 0x3F));
+    if(scalar < 0x10000)
+        return ((0xE0 | (scalar >> 12)) << 16) | ((0x80 | ((scalar >> 6) & 0x3F)) << 8) | (0x80 | (scalar & 0x3F));
+
+    return ((Uint32)(0xF0 | (scalar >> 18)) << 24) | ((0x80 | ((scalar >> 12) & 0x3F)) << 16) | ((0x80 | ((scalar >> 6) & 0x3F)) << 8) | (0x80 | (scalar & 0x3F));
+}
+
+// Roughly what the UI's strings cover: ASCII, Latin-1 and punctuation, ~2000 CJK ideographs and a few astral symbols
+static int FC_TestMapKeys(Uint32* keys)
+{
+    int n = 0, i;
+    for(i = 0x20; i < 0x7F; ++i)
+        keys[n++] = i;
+    for(i = 0xA0; i < 0x100; ++i)
+        keys[n++] = FC_TestPack(i);
+    keys[n++] = FC_TestPack(0x2014);
+    keys[n++] = FC_TestPack(0x3001);
+    keys[n++] = FC_TestPack(0xFF1A);
+    for(i = 0; i < 2000; ++i)
+        keys[n++] = FC_TestPack(0x4E00 + (i * 37) % 0x5200);
+    for(i = 0; i < 16; ++i)
+        keys[n++] = FC_TestPack(0x1F600 + i);
+
+    return n;
+}
+
+static void FC_TestMap(void)
+{
+    static Uint32 keys[4096];
+    int n = FC_TestMapKeys(keys), i;
+    FC_Map* map = FC_MapCreate();
+
+    for(i = 0; i < n; ++i)
+        FC_MapInsert(map, keys[i], FC_MakeGlyphData(0, i, 0, 1, 1));
+
+    for(i = 0; i < n; ++i)
+    {
+        FC_GlyphData* glyph = FC_MapFind(map, keys[i]);
+        FC_CHECK(glyph != NULL && glyph->rect.x == i, "map: key 0x%x not found after insert", keys[i]);
+    }
+
+    // Absent keys in every kind of table: ASCII, CJK, three-byte outside CJK, and the probe table
+    FC_CHECK(FC_MapFind(map, 0x7F) == NULL, "map: found absent ASCII key");
+    FC_CHECK(FC_MapFind(map, FC_TestPack(0x4E01)) == NULL, "map: found absent CJK key");
+    FC_CHECK(FC_MapFind(map, FC_TestPack(0x3002)) == NULL, "map: found absent three-byte key");
+    FC_CHECK(FC_MapFind(map, FC_TestPack(0x1F610)) == NULL, "map: found absent four-byte key");
+    FC_CHECK(FC_MapFind(map, FC_TestPack(0x4E00) | 0xF0000000u) == NULL, "map: CJK table matched a non-CJK key");
+
+    // A duplicate replaces the stored glyph in place
+    FC_MapInsert(map, 'A', FC_MakeGlyphData(0, 1234, 0, 1, 1));
+    FC_CHECK(FC_MapFind(map, 'A')->rect.x == 1234 && map->ascii_glyphs['A']->rect.x == 1234, "map: duplicate insert did not replace");
+
+    FC_MapFree(map);
+}
+
+static size_t FC_TestASCIIRunLength(const char* text)
+{
+    const unsigned char* c = (const unsigned char*)text;
+    for(; *c != '\0' && *c < 0x80; ++c)
+        ;
+    return c - (const unsigned char*)text;
+}
+
+static void FC_TestASCIIRunCase(const char* text)
+{
+    size_t expected = FC_TestASCIIRunLength(text);
+    size_t got = FC_GetASCIIRunLength(text), got_words = FC_GetASCIIRunLengthWords(text);
+
+    FC_CHECK(got == expected, "run length: %zu, expected %zu at offset %zu", got, expected, (size_t)text & 15);
+    FC_CHECK(got_words == expected, "run length (words): %zu, expected %zu at offset %zu", got_words, expected, (size_t)text & 15);
+}
+
+// Both scans against the plain loop: every alignment, every run length up to three blocks (so every tail shorter than
+// a block) and each kind of stop byte, then random text, then runs that end on the last byte of a readable page.
+static void FC_TestASCIIRun(void)
+{
+    static const unsigned char stops[] = {0x00, 0x80, 0xC3, 0xFF};
+    static char buffer[128] __attribute__((aligned(16)));
+    long page_size = sysconf(_SC_PAGESIZE);
+    unsigned int seed = 7;
+    size_t offset, len, stop, trial, i;
+    char* pages;
+
+    for(offset = 0; offset < 16; ++offset)
+    {
+        for(len = 0; len <= 48; ++len)
+        {
+            for(stop = 0; stop < sizeof(stops); ++stop)
+            {
+                char* text = buffer + offset;
+                memset(buffer, 'a', sizeof(buffer));
+                text[len] = (char)stops[stop];
+                text[len + 1] = '\0';
+                FC_TestASCIIRunCase(text);
+            }
+        }
+    }
+
+    for(trial = 0; trial < 100000; ++trial)
+    {
+        size_t size;
+        seed = seed * 1103515245 + 12345;
+        offset = (seed >> 8) % 16;
+        size = (seed >> 12) % 96;
+        for(i = 0; i < size; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            // Mostly ASCII, with the odd multibyte lead or continuation byte
+            buffer[offset + i] = ((seed >> 16) % 32 == 0)? (char)(0x80 | (seed >> 8)) : (char)(0x20 + (seed >> 8) % 0x5F);
+        }
+
+        buffer[offset + size] = '\0';
+        FC_TestASCIIRunCase(buffer + offset);
+    }
+
+    pages = (char*)mmap(NULL, page_size * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(pages == MAP_FAILED || mprotect(pages + page_size, page_size, PROT_NONE) != 0)
+    {
+        FC_CHECK(0, "run length: could not map a guard page");
+        return;
+    }
+
+    for(len = 0; len <= 40; ++len)
+    {
+        char* text = pages + page_size - 1 - len;
+        memset(text, 'a', len);
+        text[len] = '\0';
+        FC_TestASCIIRunCase(text);
+    }
+
+    munmap(pages, page_size * 2);
+}
+
+// Lookups per second on a text-like stream, 70% ASCII and 30% CJK
+static void FC_BenchMap(void)
+{
+    static Uint32 keys[4096], stream[1 << 16];
+    int n = FC_TestMapKeys(keys), i, pass, round;
+    const int rounds = 400;
+    unsigned int seed = 1;
+    volatile long sink = 0;
+    FC_Map* map = FC_MapCreate();
+
+    for(i = 0; i < n; ++i)
+        FC_MapInsert(map, keys[i], FC_MakeGlyphData(0, i, 0, 1, 1));
+
+    for(i = 0; i < (1 << 16); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        stream[i] = ((seed >> 16) % 10 < 7)? keys[(seed >> 8) % 95] : keys[n - 17 - (seed >> 4) % 2000];
+    }
+
+    // The first pass only warms up the caches
+    for(pass = 0; pass < 2; ++pass)
+    {
+        double start = FC_TestNow(), elapsed;
+        for(round = 0; round < rounds; ++round)
+        {
+            for(i = 0; i < (1 << 16); ++i)
+                sink += FC_MapFind(map, stream[i])->rect.w;
+        }
+
+        elapsed = FC_TestNow() - start;
+        if(pass == 1)
+            printf("FC_MapFind: %.1f M lookups/s\n", rounds * 65536.0 / elapsed / 1e6);
+    }
+
+    FC_MapFree(map);
+}
+
+// Widths measured on worker threads while the main thread, standing in for the render thread, keeps adding glyphs.
+// ASCII glyphs are 10 wide and CJK glyphs 25; a CJK glyph not added yet must be measured as a space and reported.
+static FC_Font* stress_font;
+static int stress_done;
+static long stress_errors;
+
+static void* FC_TestStressWorker(void* arg)
+{
+    long id = (long)arg, n = 0;
+    const char* cjk = "\xE5\x9B\xBA\xE4\xBB\xB6\xE7\x89\x88\xE6\x9C\xAC";  // 固件版本
+
+    while(!__atomic_load_n(&stress_done, __ATOMIC_RELAXED))
+    {
+        Uint8 complete;
+        Uint16 width = FC_GetWidth(stress_font, "Serial %ld: XAW%08ld", id, n);
+        if(width != 10 * 21)
+            __atomic_add_fetch(&stress_errors, 1, __ATOMIC_RELAXED);
+
+        // Each of the four is either cached (25) or a space (10), and anything short of 100 must be flagged
+        width = FC_GetWidthUnformattedComplete(stress_font, cjk, &complete);
+        if(width < 40 || width > 100 || (width - 40) % 15 != 0 || complete != (width == 100))
+            __atomic_add_fetch(&stress_errors, 1, __ATOMIC_RELAXED);
+
+        ++n;
+    }
+
+    FC_FreeBuffer();
+    return (void*)n;
+}
+
+static void FC_TestStress(void)
+{
+    pthread_t threads[6];
+    long i, total = 0;
+
+    stress_font = FC_CreateFont();
+    FC_ClearFont(stress_font);
+    for(i = 0x20; i < 0x7F; ++i)
+        FC_SetGlyphData(stress_font, i, FC_MakeGlyphData(0, 0, 0, 10, 25));
+
+    for(i = 0; i < 6; ++i)
+        pthread_create(&threads[i], NULL, FC_TestStressWorker, (void*)i);
+
+    // All of CJK, then a range that goes through the probe table
+    for(i = 0x4E00; i < 0xA000; ++i)
+        FC_SetGlyphData(stress_font, FC_TestPack(i), FC_MakeGlyphData(0, 0, 0, 25, 25));
+    for(i = 0x3000; i < 0x4E00; ++i)
+        FC_SetGlyphData(stress_font, FC_TestPack(i), FC_MakeGlyphData(0, 0, 0, 25, 25));
+
+    __atomic_store_n(&stress_done, 1, __ATOMIC_RELAXED);
+    for(i = 0; i < 6; ++i)
+    {
+        void* n;
+        pthread_join(threads[i], &n);
+        total += (long)n;
+    }
+
+    FC_CHECK(stress_errors == 0, "stress: %ld wrong widths in %ld measurements", stress_errors, total * 2);
+    FC_CHECK(FC_GetWidthUnformatted(stress_font, "\xE5\x9B\xBA") == 25, "stress: glyph inserted during the run is missing");
+
+    FC_FreeFont(stress_font);
+}
+
+// Bytes per second through each run-length scan, over UI-sized strings split by the odd multibyte character
+static void FC_BenchASCIIRun(void)
+{
+    static char text[1 << 16] __attribute__((aligned(16)));
+    static const struct {
+        const char* name;
+        size_t (*scan)(const char*);
+    } scans[] = {
+        {"FC_GetASCIIRunLength", FC_GetASCIIRunLength},
+        {"FC_GetASCIIRunLengthWords", FC_GetASCIIRunLengthWords},
+        {"byte loop", FC_TestASCIIRunLength},
+    };
+    const int rounds = 400;
+    unsigned int seed = 3;
+    volatile size_t sink = 0;
+    size_t i, scan;
+
+    for(i = 0; i < sizeof(text) - 1; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        text[i] = ((seed >> 16) % 48 == 0)? (char)0xE4 : (char)(0x20 + (seed >> 8) % 0x5F);
+    }
+
+    for(scan = 0; scan < sizeof(scans) / sizeof(scans[0]); ++scan)
+    {
+        int pass, round;
+        // The first pass only warms up the caches
+        for(pass = 0; pass < 2; ++pass)
+        {
+            double start = FC_TestNow(), elapsed;
+            for(round = 0; round < rounds; ++round)
+            {
+                const char* c = text;
+                while(*c != '\0')
+                {
+                    size_t run = scans[scan].scan(c);
+                    sink += run;
+                    c += run + (c[run] != '\0');
+                }
+            }
+
+            elapsed = FC_TestNow() - start;
+            if(pass == 1)
+                printf("%s: %.0f MB/s\n", scans[scan].name, rounds * (sizeof(text) - 1) / elapsed / 1e6);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        FC_BenchMap();
+        FC_BenchASCIIRun();
+        return 0;
+    }
+
+    FC_TestMap();
+    FC_TestASCIIRun();
+    FC_TestStress();
+
+    printf("fontcache: %s\n", (failures == 0)? "ok" : "FAILED");
+    return (failures == 0)? 0 : 1;
+}
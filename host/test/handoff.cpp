@@ -0,0 +1,126 @@
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "fake_backend.hpp"
+#include "sampler.hpp"
+#include "triple_buffer.hpp"
+
+// Checks the sampler's snapshot handoff while every fake service call sleeps for a jittered time (see
+// host/handoff.ini). Exits non-zero if any snapshot was torn or stale.
+namespace Handoff {
+    static const u64 NumPublishes = 200000;
+    static const int PayloadWords = 64;
+
+    struct Payload {
+        u64 sequence;
+        u64 words[PayloadWords];
+    };
+
+    static u64 GetWord(u64 sequence, int index) {
+        return (sequence * 0x9E3779B97F4A7C15ULL) ^ static_cast<u64>(index);
+    }
+
+    // A writer and a reader hammer a TripleBuffer directly, both stalling on jittered fake calls now and then. Every
+    // slot the reader gets must be whole, never older than the last one it saw, and never older than the last
+    // publish that completed before it asked.
+    static bool CheckTripleBuffer(void) {
+        static TripleBuffer<Payload> buffer;
+        std::atomic<u64> published(0);
+        std::atomic<bool> done(false);
+
+        std::thread writer([&] {
+            for (u64 sequence = 1; sequence <= NumPublishes; sequence++) {
+                Payload *payload = buffer.GetWriteBuffer();
+                payload->sequence = sequence;
+                for (int i = 0; i < PayloadWords; i++) {
+                    payload->words[i] = Handoff::GetWord(sequence, i);
+
+                    // Stalling halfway through a write gives the reader a chance to see the slot half done.
+                    if ((i == PayloadWords / 2) && ((sequence % 64) == 0))
+                        FakeBackend::Call(FakeBackend::FakeService_Fs);
+                }
+
+                buffer.Publish();
+                published.store(sequence, std::memory_order_release);
+            }
+
+            done.store(true);
+        });
+
+        u64 acquires = 0, last = 0, torn = 0, stale = 0;
+        while (!done.load()) {
+            u64 latest = published.load(std::memory_order_acquire);
+            const Payload *payload = buffer.Acquire();
+            acquires++;
+
+            // Sequence 0 is the zeroed slot the reader starts on, before anything was published.
+            u64 sequence = payload->sequence;
+            bool whole = true;
+            for (int i = 0; (sequence != 0) && (i < PayloadWords); i++) {
+                if ((i == PayloadWords / 2) && ((acquires % 64) == 0))
+                    FakeBackend::Call(FakeBackend::FakeService_Hid);
+
+                whole &= (payload->words[i] == Handoff::GetWord(sequence, i));
+            }
+
+            if (!whole || (payload->sequence != sequence))
+                torn++;
+
+            if ((sequence < latest) || (sequence < last))
+                stale++;
+
+            last = sequence;
+        }
+
+        writer.join();
+
+        // Once the writer is done the reader has to end up on the final publish.
+        const Payload *final_payload = buffer.Acquire();
+        bool passed = (torn == 0) && (stale == 0) && (final_payload->sequence == NumPublishes);
+        std::printf("triple buffer: %llu publishes, %llu acquires, %llu torn, %llu stale, final %llu: %s\n",
+            (unsigned long long)NumPublishes, (unsigned long long)acquires, (unsigned long long)torn,
+            (unsigned long long)stale, (unsigned long long)final_payload->sequence, passed? "ok" : "FAILED");
+
+        return passed;
+    }
+
+    // The real sampler thread against the jittered fake services: whenever WaitForSnapshot() reports a new
+    // snapshot, GetSnapshot() must already return it or a newer one.
+    static bool CheckSampler(void) {
+        Sampler::Init();
+        SwitchIdent::EnableSnapshotCategories(SwitchIdent::SnapshotCategory_All);
+
+        u64 waits = 0, last = 0, stale = 0, timeouts = 0;
+        for (int i = 0; i < 200; i++) {
+            SwitchIdent::InvalidateSnapshot(SwitchIdent::SnapshotEvent_PowerState | SwitchIdent::SnapshotEvent_SdCard);
+            Sampler::Wake();
+
+            if (!Sampler::WaitForSnapshot(last, 1000000000ULL)) {
+                timeouts++;
+                continue;
+            }
+
+            waits++;
+            const SwitchIdent::SystemSnapshot *snapshot = Sampler::GetSnapshot();
+            if (snapshot->sequence <= last)
+                stale++;
+
+            last = snapshot->sequence;
+        }
+
+        Sampler::Exit();
+
+        bool passed = (stale == 0) && (timeouts == 0);
+        std::printf("sampler: %llu snapshots, %llu stale, %llu timeouts: %s\n", (unsigned long long)waits,
+            (unsigned long long)stale, (unsigned long long)timeouts, passed? "ok" : "FAILED");
+
+        return passed;
+    }
+}
+
+int main(void) {
+    bool passed = Handoff::CheckTripleBuffer();
+    passed &= Handoff::CheckSampler();
+    return passed? 0 : 1;
+}
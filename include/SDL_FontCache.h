@@ -143,6 +143,33 @@ Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, S
 Uint8 FC_LoadFont_RW(FC_Font* font, SDL_Renderer* renderer, SDL_RWops* file_rwops_ttf, Uint8 own_rwops, Uint32 pointSize, SDL_Color color, int style);
 #endif
 
+/*! Rasterises the loading string into CPU-side cache surfaces without using the renderer, so it can run on a loader
+    thread as long as nothing else uses the font meanwhile.  The font cannot be drawn with until
+    FC_UploadPreparedGlyphCache() has uploaded every level. */
+Uint8 FC_PrepareFontFromTTF(FC_Font* font, TTF_Font* ttf, SDL_Color color);
+
+/*! Uploads the next cache level prepared by FC_PrepareFontFromTTF().  Returns how many are still waiting. */
+#ifdef FC_USE_SDL_GPU
+int FC_UploadPreparedGlyphCache(FC_Font* font);
+#else
+int FC_UploadPreparedGlyphCache(FC_Font* font, SDL_Renderer* renderer);
+#endif
+
+/*! Writes the glyph map, metrics and cache levels prepared by FC_PrepareFontFromTTF() (before any are uploaded) to
+    'dest', tagged with the given font hash and point size. */
+Uint8 FC_WritePreparedFont(FC_Font* font, SDL_RWops* dest, Uint64 font_hash, Uint32 point_size);
+
+/*! Writes the font's current glyph map and cache levels, including glyphs added since it was loaded, in the same
+    format as FC_WritePreparedFont().  The levels are read back from the GPU, so this is meant for shutdown; with
+    SDL_Renderer it needs render target support.  Returns 0 if the font is still uploading or a level can't be read. */
+Uint8 FC_SaveGlyphCache(FC_Font* font, SDL_RWops* dest, Uint64 font_hash, Uint32 point_size);
+
+/*! Like FC_PrepareFontFromTTF(), but takes the glyphs and cache levels from a file written by FC_WritePreparedFont()
+    or FC_SaveGlyphCache() instead of rasterising them.  Returns 0 if the file was made for another font hash or point
+    size (the font is left untouched) or is damaged (the font is cleared).  'ttf' may be NULL; otherwise it is used
+    for glyphs the file lacks and must outlive the font. */
+Uint8 FC_PrepareFontFromCache(FC_Font* font, SDL_RWops* src, TTF_Font* ttf, Uint64 font_hash, Uint32 point_size, SDL_Color color);
+
 #ifndef FC_USE_SDL_GPU
 // note: handle SDL event types SDL_RENDER_TARGETS_RESET(>= SDL 2.0.2) and SDL_RENDER_DEVICE_RESET(>= SDL 2.0.4)
 void FC_ResetFontFromRendererReset(FC_Font* font, SDL_Renderer* renderer, Uint32 evType);
@@ -215,12 +242,20 @@ void U8_strdel(char* string, int position);
 /*! Sets the string from which to load the initial glyphs.  Use this if you need upfront loading for any reason (such as lack of render-target support). */
 void FC_SetLoadingString(FC_Font* font, const char* string);
 
-/*! Returns the size of the internal buffer which is used for unpacking variadic text data.  This buffer is shared by all FC_Fonts. */
+/*! Returns the size of the internal buffer which is used for unpacking variadic text data.  Each thread has its own buffer, shared by all FC_Fonts. */
 unsigned int FC_GetBufferSize(void);
 
-/*! Changes the size of the internal buffer which is used for unpacking variadic text data.  This buffer is shared by all FC_Fonts. */
+/*! Changes the size of the internal buffers which are used for unpacking variadic text data.  Other threads resize theirs the next time they format text. */
 void FC_SetBufferSize(unsigned int size);
 
+/*! Frees the calling thread's variadic text buffer.  Threads other than the one that frees the last font should call this before they exit.
+
+    Threading: any thread may measure text (FC_GetWidth(), FC_GetHeight() and friends) while the render thread draws
+    with the same font.  Glyphs missing from the cache are only rasterised on the thread that uploaded the cache;
+    elsewhere they measure as a space.  Loading, clearing, freeing and drawing stay on the render thread, and
+    FC_SetGlyphData() must not replace a glyph that other threads may be reading. */
+void FC_FreeBuffer(void);
+
 /*! Returns the width of a single horizontal tab in multiples of the width of a space (default: 4) */
 unsigned int FC_GetTabWidth(void);
 
@@ -257,7 +292,7 @@ void FC_GetCodepoints(FC_Font* font, Uint32* result);
 /*! Stores the glyph data for the given codepoint in 'result'.  Returns 0 if the codepoint was not found in the cache. */
 Uint8 FC_GetGlyphData(FC_Font* font, FC_GlyphData* result, Uint32 codepoint);
 
-/*! Sets the glyph data for the given codepoint.  Duplicates are not checked.  Returns a pointer to the stored data. */
+/*! Sets the glyph data for the given codepoint, replacing any stored for it.  Returns a pointer to the stored data, which stays valid until the font is cleared. */
 FC_GlyphData* FC_SetGlyphData(FC_Font* font, Uint32 codepoint, FC_GlyphData glyph_data);
 
 
@@ -267,6 +302,8 @@ FC_Rect FC_Draw(FC_Font* font, FC_Target* dest, float x, float y, const char* fo
 FC_Rect FC_DrawAlign(FC_Font* font, FC_Target* dest, float x, float y, FC_AlignEnum align, const char* formatted_text, ...);
 FC_Rect FC_DrawScale(FC_Font* font, FC_Target* dest, float x, float y, FC_Scale scale, const char* formatted_text, ...);
 FC_Rect FC_DrawColor(FC_Font* font, FC_Target* dest, float x, float y, SDL_Color color, const char* formatted_text, ...);
+/*! As FC_DrawColor(), but draws 'text' as given instead of formatting it first, so strings containing '%' are safe. */
+FC_Rect FC_DrawColorUnformatted(FC_Font* font, FC_Target* dest, float x, float y, SDL_Color color, const char* text);
 FC_Rect FC_DrawEffect(FC_Font* font, FC_Target* dest, float x, float y, FC_Effect effect, const char* formatted_text, ...);
 
 FC_Rect FC_DrawBox(FC_Font* font, FC_Target* dest, FC_Rect box, const char* formatted_text, ...);
@@ -288,6 +325,13 @@ FC_FilterEnum FC_GetFilterMode(FC_Font* font);
 Uint16 FC_GetLineHeight(FC_Font* font);
 Uint16 FC_GetHeight(FC_Font* font, const char* formatted_text, ...);
 Uint16 FC_GetWidth(FC_Font* font, const char* formatted_text, ...);
+/*! As FC_GetHeight() and FC_GetWidth(), but measure 'text' as given instead of formatting it into the calling
+    thread's buffer first, so they are cheaper and safe for strings containing '%'. */
+Uint16 FC_GetHeightUnformatted(FC_Font* font, const char* text);
+Uint16 FC_GetWidthUnformatted(FC_Font* font, const char* text);
+/*! As FC_GetWidthUnformatted(), and sets '*complete' to 0 if any glyph was measured as a space because it is not cached
+    yet and only the render thread can add it.  Such a width is provisional and should not be kept. */
+Uint16 FC_GetWidthUnformattedComplete(FC_Font* font, const char* text, Uint8* complete);
 
 // Returns a 1-pixel wide box in front of the character in the given position (index)
 FC_Rect FC_GetCharacterOffset(FC_Font* font, Uint16 position_index, int column_width, const char* formatted_text, ...);
@@ -0,0 +1,33 @@
+#ifndef _SWITCHIDENT_ASSETS_H_
+#define _SWITCHIDENT_ASSETS_H_
+
+#include <switch.h>
+
+// Images pre-decoded at build time by tools/pack_atlas.py into a single bundle of LZ4-compressed, texture-ready
+// pixels, so startup does one small read and an LZ4 decode instead of decoding PNGs.
+namespace Assets {
+    struct Image {
+        const char *name;
+        u32 format; // SDL_PixelFormatEnum of `pixels`.
+        int width;
+        int height;
+        int pitch;
+        const void *pixels;
+    };
+
+    // Reads the whole bundle at `path` in one go and decodes it. Returns 0 on success, -1 if it is missing or malformed.
+    int Load(const char *path);
+    // The image called `name`, or nullptr. Valid until Free().
+    const Image *Find(const char *name);
+    void Free(void);
+
+    // Reads a whole file with one read into memory the caller frees with std::free(). Returns nullptr on failure.
+    void *ReadFile(const char *path, size_t *size);
+    // 64-bit FNV-1a, which tags files derived from another (e.g. a glyph cache from its font).
+    u64 Hash(const void *data, size_t size);
+    // Identifies a TrueType/OpenType font by its size and table directory. The directory carries a checksum of every
+    // table, so this tells fonts apart like hashing the whole file would, in a few hundred bytes instead of all of it.
+    u64 HashFont(const void *data, size_t size);
+}
+
+#endif
@@ -0,0 +1,42 @@
+// Generated by tools/pack_atlas.py from assets/*.png; do not edit.
+#ifndef _SWITCHIDENT_ATLAS_H_
+#define _SWITCHIDENT_ATLAS_H_
+
+namespace Atlas {
+    static const int Width = 512;
+    static const int Height = 256;
+
+    enum Sprite {
+        Sprite_Banner = 0,
+        Sprite_Drive,
+        Sprite_Kernel,
+        Sprite_System,
+        Sprite_Power,
+        Sprite_Storage,
+        Sprite_Joycon,
+        Sprite_Misc,
+        Sprite_Exit,
+        Sprite_Count
+    };
+
+    struct SpriteRect {
+        int x;
+        int y;
+        int w;
+        int h;
+    };
+
+    static const SpriteRect Sprites[Sprite_Count] = {
+        { 1, 1, 200, 200 }, // Sprite_Banner
+        { 202, 1, 128, 128 }, // Sprite_Drive
+        { 393, 1, 30, 30 }, // Sprite_Kernel
+        { 32, 202, 30, 30 }, // Sprite_System
+        { 455, 1, 30, 30 }, // Sprite_Power
+        { 1, 202, 30, 30 }, // Sprite_Storage
+        { 362, 1, 30, 30 }, // Sprite_Joycon
+        { 424, 1, 30, 30 }, // Sprite_Misc
+        { 331, 1, 30, 30 }, // Sprite_Exit
+    };
+}
+
+#endif
@@ -4,6 +4,43 @@
 #include <switch.h>
 
 namespace SwitchIdent {
+    enum StorageSlot {
+        StorageSlot_SdCard = 0,
+        StorageSlot_BuiltInUser,
+        StorageSlot_BuiltInSystem,
+        StorageSlot_GameCard,
+        StorageSlot_Count
+    };
+
+    struct StorageUsage {
+        NcmStorageId storage_id;
+        bool present;
+        s64 total;
+        s64 free;
+        s64 used;
+    };
+
+    struct StorageStats {
+        StorageUsage slots[StorageSlot_Count];
+    };
+
+    struct JoyconPower {
+        HidNpadIdType id;
+        u32 style_set;
+        bool is_split;      // Split styles report the left and right Joy-Con separately.
+        bool has_left;
+        bool has_right;
+        HidPowerInfo single;
+        HidPowerInfo left;
+        HidPowerInfo right;
+    };
+
+    // Handheld plus No1-No8.
+    struct JoyconPowerList {
+        int count;
+        JoyconPower pads[9];
+    };
+
     // Kernel
     const char *GetDramDesc(void);
     SetSysFirmwareVersion GetFirmwareVersion(void);
@@ -24,6 +61,8 @@ namespace SwitchIdent {
     bool GetConsoleInformationUploadFlag(void);
     bool IsSDCardInserted(FsDeviceOperator *fsDeviceOperator);
     bool IsGameCardInserted(FsDeviceOperator *fsDeviceOperator);
+    FsDeviceOperator *GetDeviceOperator(void);
+    void CloseDeviceOperator(void);
 
     // Power
     u32 GetBatteryPercentage(void);
@@ -40,12 +79,15 @@ namespace SwitchIdent {
     s64 GetTotalStorage(NcmStorageId storage_id);
     s64 GetFreeStorage(NcmStorageId storage_id);
     s64 GetUsedStorage(NcmStorageId storage_id);
+    void GetStorageStats(StorageStats *stats);
     void GetSizeString(char *string, double size);
 
     // System
     u64 GetLanguage(void);
     const char *GetRegion(void);
     u32 GetClock(PcvModule module);
+    void GetClocks(const PcvModule *modules, u32 *out, int count);
+    void CloseClockSessions(void);
     SetCalBdAddress GetBluetoothBdAddress(void);
     SetCalMacAddress GetWirelessLanMacAddress(void);
 
@@ -57,8 +99,7 @@ namespace SwitchIdent {
     // Joycon
     u128 GetJoyconFirmwareVersion(HidsysUniquePadId unique_pad_id);
     HidPowerInfo GetJoyconPowerInfo(HidNpadIdType id);
-    HidPowerInfo GetJoyconPowerInfoL(HidNpadIdType id);
-    HidPowerInfo GetJoyconPowerInfoR(HidNpadIdType id);
+    void GetJoyconPowerList(JoyconPowerList *list);
 }
 
 #endif
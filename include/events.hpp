@@ -0,0 +1,15 @@
+#ifndef _SWITCHIDENT_EVENTS_H_
+#define _SWITCHIDENT_EVENTS_H_
+
+#include <switch.h>
+
+namespace Events {
+    void Init(void);
+    void Exit(void);
+
+    // Marks the snapshot fields affected by `events` (a mask of SwitchIdent::SnapshotEvent) dirty and wakes the
+    // sampler. The waiter thread posts OS notifications through here; other event sources can too.
+    void Post(u32 events);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef _SWITCHIDENT_GOVERNOR_H_
+#define _SWITCHIDENT_GOVERNOR_H_
+
+#include <switch.h>
+
+// Picks the main loop's pacing from user activity and applet focus.
+namespace Governor {
+    enum State {
+        State_Active = 0, // Navigating: input is polled every vsync.
+        State_Idle,       // No input for a while: a few polls per second.
+        State_Suspended,  // Out of focus or in the background: no rendering and no sampling.
+        State_Count
+    };
+
+    // Called once per main loop iteration; returns the state for this iteration. Time spent in each state is
+    // recorded under "Governor::<state>" in the call statistics, one sample per stay.
+    State Update(bool input);
+
+    // How long an iteration that draws nothing should wait before polling again.
+    u64 GetPollInterval(State state);
+}
+
+#endif
@@ -4,18 +4,31 @@
 #include <switch.h>
 #include <SDL2/SDL.h>
 
-extern SDL_Texture *banner, *drive, *menu_icons[7];
+#include "atlas.hpp"
 
 namespace GUI {
+    // Brings up SDL and starts loading the atlas and font on a loader thread; drawing works straight away, but text and
+    // sprites only appear once UpdateLoading() has uploaded them.
     int Init(void);
     void Exit(void);
+    // Uploads whatever the loader has finished since the last call, a piece at a time. Returns true when that makes
+    // something new drawable, i.e. the frame should be rebuilt and text re-measured.
+    bool UpdateLoading(void);
+    bool IsLoaded(void);
     void ClearScreen(SDL_Color colour);
     void DrawRect(int x, int y, int w, int h, SDL_Color colour);
     void DrawText(int x, int y, int size, SDL_Color colour, const char *text);
     void DrawTextf(int x, int y, int size, SDL_Color colour, const char* text, ...);
+    // Draws `title`, `gap` pixels of space and `text` from a retained texture that is only rebuilt when a string or
+    // colour changes.
+    void DrawItem(int x, int y, int size, SDL_Color title_colour, const char *title, int gap, SDL_Color text_colour, const char *text);
+    // Render thread only, like the drawing calls: the measurements are memoised in an unsynchronised table.
     void GetTextDimensions(int size, const char *text, u32 *width, u32 *height);
-    void DrawImage(SDL_Texture *texture, int x, int y);
+    void DrawSprite(Atlas::Sprite sprite, int x, int y);
+    // Submits the frame's recorded draws, batched by texture, and presents it.
     void Render(void);
+    // Draw calls of the last presented frame: as recorded (one per rect, glyph, sprite or row) and as submitted.
+    void GetDrawCalls(u32 *recorded, u32 *submitted);
 }
 
 #endif
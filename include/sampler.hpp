@@ -0,0 +1,24 @@
+#ifndef _SWITCHIDENT_SAMPLER_H_
+#define _SWITCHIDENT_SAMPLER_H_
+
+#include "snapshot.hpp"
+
+namespace Sampler {
+    void Init(void);
+    void Exit(void);
+
+    // Cuts the current wait short so invalidated fields are re-read right away.
+    void Wake(void);
+
+    // While paused the sampler thread reads nothing; fields that fell due in the meantime are read on resume.
+    void SetPaused(bool paused);
+
+    // Latest complete snapshot published by the sampler thread. Only call this from the render thread;
+    // the pointer stays valid until the next call. `sequence` is 0 until the first snapshot lands.
+    const SwitchIdent::SystemSnapshot *GetSnapshot(void);
+
+    // Blocks until a snapshot newer than `sequence` is published or `timeout_ns` passes; returns false on timeout.
+    bool WaitForSnapshot(u64 sequence, u64 timeout_ns);
+}
+
+#endif
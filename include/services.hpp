@@ -0,0 +1,22 @@
+#ifndef _SWITCHIDENT_SERVICES_H_
+#define _SWITCHIDENT_SERVICES_H_
+
+#include <switch.h>
+
+namespace Services {
+    void Init(void);
+    void Exit(void);
+
+    // Starts (on worker threads) any deferred services the given snapshot categories read from. Categories become
+    // visible to the sampler once all of their services are up.
+    void RequireCategories(u32 categories);
+
+    // Called by the menu once the first frame has been presented; returns the time since Init() in nanoseconds.
+    u64 MarkFirstFrame(void);
+    u64 GetTimeToFirstFrame(void);
+    // Called by the menu once every asset and the font are uploaded and drawn.
+    u64 MarkFullyLoaded(void);
+    u64 GetTimeToFullyLoaded(void);
+}
+
+#endif
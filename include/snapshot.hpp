@@ -0,0 +1,103 @@
+#ifndef _SWITCHIDENT_SNAPSHOT_H_
+#define _SWITCHIDENT_SNAPSHOT_H_
+
+#include <switch.h>
+
+#include "common.hpp"
+
+namespace SwitchIdent {
+    enum SnapshotCategory {
+        SnapshotCategory_Kernel  = BIT(0),
+        SnapshotCategory_System  = BIT(1),
+        SnapshotCategory_Power   = BIT(2),
+        SnapshotCategory_Storage = BIT(3),
+        SnapshotCategory_Joycon  = BIT(4),
+        SnapshotCategory_Misc    = BIT(5),
+        SnapshotCategory_All     = 0x3F
+    };
+
+    // How often a snapshot field is re-read by RefreshSnapshot().
+    enum RefreshClass {
+        RefreshClass_Static = 0, // Identity data that never changes while the app runs; read once.
+        RefreshClass_Slow,       // Storage, settings flags, slot status; every 10 s.
+        RefreshClass_Fast,       // Battery, RSSI, clocks; every 500 ms.
+        RefreshClass_Event,      // Read once, then again only when a matching SnapshotEvent is posted.
+        RefreshClass_Count
+    };
+
+    // OS state-change notifications that mark the snapshot fields depending on them as dirty.
+    enum SnapshotEvent {
+        SnapshotEvent_PowerState = BIT(0), // psm: charger, power supply or battery voltage changed.
+        SnapshotEvent_SdCard     = BIT(1), // fs: SD card inserted/removed.
+        SnapshotEvent_GameCard   = BIT(2), // fs: gamecard inserted/removed.
+        SnapshotEvent_Network    = BIT(3)  // Network state changed.
+    };
+
+    struct KernelData {
+        SetSysFirmwareVersion firmware_version;
+        const char *hardware_type;
+        const char *unit;
+        SetSysSerialNumber serial_number;
+        const char *dram_desc;
+        u64 device_id;
+    };
+
+    struct SystemData {
+        const char *region;
+        u32 cpu_clock;
+        u32 gpu_clock;
+        u32 emc_clock;
+        bool wlan_enabled;
+        u32 wlan_rssi;
+        s32 wlan_quality;
+        bool bluetooth_enabled;
+        bool nfc_enabled;
+    };
+
+    struct PowerData {
+        u32 battery_percentage;
+        bool is_charging;
+        const char *voltage_state;
+        const char *charger_type;
+        bool charging_enabled;
+        bool enough_power_supplied;
+        SetBatteryLot battery_lot;
+    };
+
+    struct MiscData {
+        bool has_ip_address;
+        char ip_address[128];
+        const char *operation_mode;
+        bool auto_update_enabled;
+        bool console_info_upload_enabled;
+        bool sd_inserted;
+        bool gamecard_inserted;
+        SetCalBdAddress bd_addr;
+        SetCalMacAddress mac_addr;
+    };
+
+    struct SystemSnapshot {
+        u64 sequence;
+        u32 categories; // Mask of SnapshotCategory that have been read at least once.
+        KernelData kernel;
+        SystemData system;
+        PowerData power;
+        StorageStats storage;
+        JoyconPowerList joycon;
+        MiscData misc;
+    };
+
+    // Re-reads only the fields whose refresh period has expired at `now_ns`. Returns true if any field was
+    // read, and stores the time at which the next field falls due in `next_refresh_ns`.
+    bool RefreshSnapshot(SystemSnapshot *snapshot, u64 now_ns, u64 *next_refresh_ns);
+
+    // Marks every field that depends on `events` (a mask of SnapshotEvent) as due on the next RefreshSnapshot().
+    // Safe to call from any thread.
+    void InvalidateSnapshot(u32 events);
+
+    // Lets RefreshSnapshot() read the given categories (a mask of SnapshotCategory). Nothing is read until the
+    // services a category depends on are up. Safe to call from any thread.
+    void EnableSnapshotCategories(u32 categories);
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef _SWITCHIDENT_STATS_H_
+#define _SWITCHIDENT_STATS_H_
+
+#include <atomic>
+#include <switch.h>
+
+namespace Stats {
+    // Latency buckets are powers of two in nanoseconds: bucket n holds calls that took [2^n, 2^(n+1)) ns.
+    static const int NumBuckets = 40;
+    // Counters beyond this many all share one overflow counter.
+    static const int MaxCounters = 64;
+
+    struct Counter {
+        const char *name;
+        std::atomic<u64> count;
+        std::atomic<u64> errors;
+        std::atomic<Result> last_result;
+        std::atomic<u64> total_ns;
+        std::atomic<u64> max_ns;
+        std::atomic<u32> buckets[NumBuckets];
+    };
+
+    u64 GetTimeNs(void);
+    Counter *GetCounter(const char *name);
+    void Record(Counter *counter, u64 elapsed_ns, Result ret);
+
+    int GetCounterCount(void);
+    const Counter *GetCounterAt(int index);
+    // Upper bound in nanoseconds of the bucket holding the given percentile (0-100).
+    u64 GetPercentile(const Counter *counter, u32 percentile);
+    Result Dump(const char *path);
+}
+
+// Times a Result-returning libnx call and records it under the function's name, e.g.
+// `ret = STATS_CALL(setsysGetSerialNumber, &serial)`.
+#define STATS_CALL(func, ...) ([&]() -> Result { \
+    static Stats::Counter *counter = Stats::GetCounter(#func); \
+    u64 start = Stats::GetTimeNs(); \
+    Result ret = func(__VA_ARGS__); \
+    Stats::Record(counter, Stats::GetTimeNs() - start, ret); \
+    return ret; \
+}())
+
+#endif
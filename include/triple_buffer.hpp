@@ -0,0 +1,43 @@
+#ifndef _SWITCHIDENT_TRIPLE_BUFFER_H_
+#define _SWITCHIDENT_TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <switch.h>
+
+// Wait-free single-producer/single-consumer handoff. The writer always owns one slot, the reader
+// always owns another and the third sits in the middle; publishing and acquiring are a single
+// atomic exchange of the middle slot, so neither side ever blocks on the other.
+template<typename T>
+class TripleBuffer {
+    public:
+        // Writer side: the slot returned here is private to the writer until Publish().
+        T *GetWriteBuffer(void) {
+            return &buffers[back];
+        }
+
+        void Publish(void) {
+            u8 prev = middle.exchange(back | fresh_bit, std::memory_order_acq_rel);
+            back = prev & index_mask;
+        }
+
+        // Reader side: returns the newest published slot. It stays valid until the next Acquire().
+        const T *Acquire(void) {
+            if (middle.load(std::memory_order_acquire) & fresh_bit) {
+                u8 prev = middle.exchange(front, std::memory_order_acq_rel);
+                front = prev & index_mask;
+            }
+
+            return &buffers[front];
+        }
+
+    private:
+        static const u8 index_mask = 0x3;
+        static const u8 fresh_bit = 0x4;
+
+        T buffers[3] = {};
+        std::atomic<u8> middle{1};
+        u8 back = 2;
+        u8 front = 0;
+};
+
+#endif
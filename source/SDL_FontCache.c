@@ -34,6 +34,12 @@ See SDL_FontCache.h for license info.
 #define FC_MIN(a,b) ((a) < (b)? (a) : (b))
 #define FC_MAX(a,b) ((a) > (b)? (a) : (b))
 
+// Vector scan for runs of ASCII text (see FC_GetASCIIRunLength()); elsewhere it scans eight bytes at a time
+#if defined(__GNUC__) && defined(__SSE2__)
+    #include <emmintrin.h>
+    #define FC_SCAN_SSE2
+#endif
+
 
 // vsnprintf replacement from Valentin Milea:
 // http://stackoverflow.com/questions/2915672/snprintf-and-visual-studio-2010
@@ -69,9 +75,17 @@ __inline int c99_snprintf(char *outBuf, size_t size, const char *format, ...)
 #endif
 
 
+// Thread-local storage for the per-thread format buffer
+#if defined(_MSC_VER)
+    #define FC_THREAD_LOCAL __declspec(thread)
+#else
+    #define FC_THREAD_LOCAL __thread
+#endif
+
 #define FC_EXTRACT_VARARGS(buffer, start_args) \
 { \
     va_list lst; \
+    FC_ReserveBuffer(); \
     va_start(lst, start_args); \
     vsnprintf(buffer, fc_buffer_size, start_args, lst); \
     va_end(lst); \
@@ -156,10 +170,22 @@ static char* replace_concat(char** a, const char* b)
 // Width of a tab in units of the space width (sorry, no tab alignment!)
 static unsigned int fc_tab_width = 4;
 
-// Shared buffer for variadic text
-static char* fc_buffer = NULL;
+// Buffer for variadic text, one per thread so that text can be formatted and measured off the render thread.
+// fc_buffer_size is the size FC_SetBufferSize() asked for; each thread reallocates to match on its next format.
+static FC_THREAD_LOCAL char* fc_buffer = NULL;
+static FC_THREAD_LOCAL unsigned int fc_thread_buffer_size = 0;
 static unsigned int fc_buffer_size = 1024;
 
+static void FC_ReserveBuffer(void)
+{
+    if(fc_buffer != NULL && fc_thread_buffer_size == fc_buffer_size)
+        return;
+
+    free(fc_buffer);
+    fc_buffer = (char*)malloc(fc_buffer_size);
+    fc_thread_buffer_size = (fc_buffer == NULL)? 0 : fc_buffer_size;
+}
+
 static Uint8 fc_has_render_target_support = 0;
 
 // The number of fonts that has been created but not freed
@@ -278,147 +304,265 @@ FC_GlyphData FC_MakeGlyphData(int cache_level, Sint16 x, Sint16 y, Uint16 w, Uin
     return gd;
 }
 
-// Enough to hold all of the ascii characters and some.
-#define FC_DEFAULT_NUM_BUCKETS 300
+// Glyph map: entries live in fixed-size chunks (so pointers to them stay valid as the map grows) and are found by
+// entry number.  ASCII and the CJK Unified Ideographs block are indexed directly; everything else goes through an
+// open-addressing table with linear probing.  Entry numbers are stored off by one so that 0 means empty.
+// Note: Codepoints here are the UTF-8 bytes packed big-endian (see FC_GetCodepointFromUTF8()), so U+4E00..U+9FFF
+// arrives as 0xE4B880..0xE9BFBF and is unpacked to its scalar value for the CJK table.
+//
+// Lookups may run on any number of threads while one thread inserts: an entry is filled in before its number is
+// published, and a probe table that is outgrown is kept until the map is freed, for readers still using it.
+// Replacing the glyph of a codepoint that is already in the map is not safe against concurrent readers.
+#define FC_MAP_ASCII_END 0x80
+#define FC_MAP_CJK_BEGIN 0x4E00
+#define FC_MAP_CJK_END 0xA000
+#define FC_MAP_CHUNK_SIZE 256
+#define FC_MAP_MAX_CHUNKS 256  // 65536 glyphs, as many as a TrueType font can hold
+#define FC_MAP_INITIAL_SLOTS 64  // Power of two; kept at most half full.
+#define FC_MAP_INITIAL_SHIFT 26  // 32 - log2(FC_MAP_INITIAL_SLOTS)
+
+#if defined(__GNUC__)
+    #define FC_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define FC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+    // Only the writer is fenced here, so concurrent lookups need a GCC-compatible compiler
+    #define FC_LOAD_ACQUIRE(p) (*(p))
+    #define FC_STORE_RELEASE(p, v) do { SDL_MemoryBarrierRelease(); *(p) = (v); } while(0)
+#endif
 
-typedef struct FC_MapNode
+typedef struct FC_MapEntry
 {
     Uint32 key;
     FC_GlyphData value;
-    struct FC_MapNode* next;
 
-} FC_MapNode;
+} FC_MapEntry;
+
+typedef struct FC_MapSlot
+{
+    Uint32 key;
+    Uint32 entry;
+
+} FC_MapSlot;
+
+typedef struct FC_MapTable
+{
+    Uint32 num_slots;
+    int shift;  // Keeps the top log2(num_slots) bits of the hash
+    FC_MapSlot* slots;  // Allocated along with the table
+    struct FC_MapTable* outgrown;  // The table this one replaced
+
+} FC_MapTable;
 
 typedef struct FC_Map
 {
-    int num_buckets;
-    FC_MapNode** buckets;
+    Uint32 count;
+    FC_MapEntry* chunks[FC_MAP_MAX_CHUNKS];
+
+    Uint32 ascii[FC_MAP_ASCII_END];
+    FC_GlyphData* ascii_glyphs[FC_MAP_ASCII_END];  // The same entries as pointers, for the ASCII fast path
+    Uint32* cjk;  // Allocated on the first CJK insert
+
+    Uint32 num_used_slots;
+    FC_MapTable* table;
 } FC_Map;
 
 
 
-static FC_Map* FC_MapCreate(int num_buckets)
+static FC_MapTable* FC_MapCreateTable(Uint32 num_slots, int shift, FC_MapTable* outgrown)
 {
-    int i;
-    FC_Map* map = (FC_Map*)malloc(sizeof(FC_Map));
+    FC_MapTable* table = (FC_MapTable*)calloc(1, sizeof(FC_MapTable) + num_slots * sizeof(FC_MapSlot));
+    if(table == NULL)
+        return NULL;
 
-    map->num_buckets = num_buckets;
-    map->buckets = (FC_MapNode**)malloc(num_buckets * sizeof(FC_MapNode*));
+    table->num_slots = num_slots;
+    table->shift = shift;
+    table->slots = (FC_MapSlot*)(table + 1);
+    table->outgrown = outgrown;
+    return table;
+}
 
-    for(i = 0; i < num_buckets; ++i)
-    {
-        map->buckets[i] = NULL;
-    }
+static FC_Map* FC_MapCreate(void)
+{
+    FC_Map* map = (FC_Map*)calloc(1, sizeof(FC_Map));
+
+    map->table = FC_MapCreateTable(FC_MAP_INITIAL_SLOTS, FC_MAP_INITIAL_SHIFT, NULL);
 
     return map;
 }
 
-/*static void FC_MapClear(FC_Map* map)
+static void FC_MapFree(FC_Map* map)
 {
     int i;
+    FC_MapTable* table;
     if(map == NULL)
         return;
 
-    // Go through each bucket
-    for(i = 0; i < map->num_buckets; ++i)
+    for(i = 0; i < FC_MAP_MAX_CHUNKS; ++i)
+        free(map->chunks[i]);
+
+    for(table = map->table; table != NULL; )
     {
-        // Delete the nodes in order
-        FC_MapNode* node = map->buckets[i];
-        while(node != NULL)
-        {
-            FC_MapNode* last = node;
-            node = node->next;
-            free(last);
-        }
-        // Set the bucket to empty
-        map->buckets[i] = NULL;
+        FC_MapTable* outgrown = table->outgrown;
+        free(table);
+        table = outgrown;
     }
-}*/
 
-static void FC_MapFree(FC_Map* map)
+    free(map->cjk);
+    free(map);
+}
+
+static_inline FC_MapEntry* FC_MapGetEntry(FC_Map* map, Uint32 entry)
 {
-    int i;
-    if(map == NULL)
-        return;
+    return &map->chunks[(entry - 1) / FC_MAP_CHUNK_SIZE][(entry - 1) % FC_MAP_CHUNK_SIZE];
+}
 
-    // Go through each bucket
-    for(i = 0; i < map->num_buckets; ++i)
+// Fibonacci hashing takes the high bits of the product: the low bits of packed UTF-8 hold the fixed 10xxxxxx
+// continuation markers and would cluster.
+static_inline Uint32 FC_MapHash(Uint32 codepoint, int shift)
+{
+    return (codepoint * 2654435761u) >> shift;
+}
+
+// Returns the slot holding codepoint, or the empty slot where it would go.
+static FC_MapSlot* FC_MapProbe(FC_MapTable* table, Uint32 codepoint)
+{
+    Uint32 index = FC_MapHash(codepoint, table->shift);
+    while(FC_LOAD_ACQUIRE(&table->slots[index].entry) != 0 && table->slots[index].key != codepoint)
+        index = (index + 1) & (table->num_slots - 1);
+
+    return &table->slots[index];
+}
+
+static Uint8 FC_MapGrowSlots(FC_Map* map)
+{
+    Uint32 i;
+    FC_MapTable* old = map->table;
+    FC_MapTable* table = FC_MapCreateTable(old->num_slots * 2, old->shift - 1, old);
+    if(table == NULL)
+        return 0;
+
+    for(i = 0; i < old->num_slots; ++i)
     {
-        // Delete the nodes in order
-        FC_MapNode* node = map->buckets[i];
-        while(node != NULL)
+        if(old->slots[i].entry != 0)
+            *FC_MapProbe(table, old->slots[i].key) = old->slots[i];
+    }
+
+    FC_STORE_RELEASE(&map->table, table);
+    return 1;
+}
+
+// The scalar value of a packed three-byte sequence, or 0 if codepoint is anything else.
+static_inline Uint32 FC_MapUnpack3(Uint32 codepoint)
+{
+    if((codepoint & 0xFFF0C0C0) != 0xE08080)
+        return 0;
+
+    return ((codepoint >> 4) & 0xF000) | ((codepoint >> 2) & 0x0FC0) | (codepoint & 0x3F);
+}
+
+// Where the entry number for codepoint is kept, or NULL if there is no room for it.  Only the inserting thread may
+// pass 'insert'.
+static Uint32* FC_MapLocate(FC_Map* map, Uint32 codepoint, Uint8 insert)
+{
+    FC_MapSlot* slot;
+    Uint32* cjk;
+    Uint32 scalar;
+
+    if(codepoint < FC_MAP_ASCII_END)
+        return &map->ascii[codepoint];
+
+    scalar = FC_MapUnpack3(codepoint);
+    if(scalar >= FC_MAP_CJK_BEGIN && scalar < FC_MAP_CJK_END)
+    {
+        cjk = FC_LOAD_ACQUIRE(&map->cjk);
+        if(cjk == NULL && insert)
         {
-            FC_MapNode* last = node;
-            node = node->next;
-            free(last);
+            cjk = (Uint32*)calloc(FC_MAP_CJK_END - FC_MAP_CJK_BEGIN, sizeof(Uint32));
+            FC_STORE_RELEASE(&map->cjk, cjk);
         }
+        return (cjk == NULL)? NULL : &cjk[scalar - FC_MAP_CJK_BEGIN];
     }
 
-    free(map->buckets);
-    free(map);
+    if(insert && (map->num_used_slots + 1) * 2 > map->table->num_slots && !FC_MapGrowSlots(map))
+        return NULL;
+
+    slot = FC_MapProbe(FC_LOAD_ACQUIRE(&map->table), codepoint);
+    if(insert && slot->entry == 0)
+    {
+        slot->key = codepoint;
+        map->num_used_slots++;
+    }
+
+    return &slot->entry;
 }
 
-// Note: Does not handle duplicates in any special way.
+// Note: A duplicate codepoint replaces the stored glyph.
 static FC_GlyphData* FC_MapInsert(FC_Map* map, Uint32 codepoint, FC_GlyphData glyph)
 {
-    Uint32 index;
-    FC_MapNode* node;
+    Uint32* entry;
+    Uint32 number;
+    FC_MapEntry* node;
     if(map == NULL)
         return NULL;
 
-    // Get index for bucket
-    index = codepoint % map->num_buckets;
-
-    // If this bucket is empty, create a node and return its value
-    if(map->buckets[index] == NULL)
-    {
-        node = map->buckets[index] = (FC_MapNode*)malloc(sizeof(FC_MapNode));
-        node->key = codepoint;
-        node->value = glyph;
-        node->next = NULL;
-        return &node->value;
-    }
+    entry = FC_MapLocate(map, codepoint, 1);
+    if(entry == NULL)
+        return NULL;
 
-    for(node = map->buckets[index]; node != NULL; node = node->next)
+    number = *entry;
+    if(number == 0)
     {
-        // Find empty node and add a new one on.
-        if(node->next == NULL)
+        // Open a new chunk when the last one is full
+        if(map->count % FC_MAP_CHUNK_SIZE == 0)
         {
-            node->next = (FC_MapNode*)malloc(sizeof(FC_MapNode));
-            node = node->next;
+            if(map->count / FC_MAP_CHUNK_SIZE >= FC_MAP_MAX_CHUNKS)
+                return NULL;
 
-            node->key = codepoint;
-            node->value = glyph;
-            node->next = NULL;
-            return &node->value;
+            map->chunks[map->count / FC_MAP_CHUNK_SIZE] = (FC_MapEntry*)malloc(FC_MAP_CHUNK_SIZE * sizeof(FC_MapEntry));
+            if(map->chunks[map->count / FC_MAP_CHUNK_SIZE] == NULL)
+                return NULL;
         }
+
+        number = map->count + 1;
+    }
+
+    node = FC_MapGetEntry(map, number);
+    node->key = codepoint;
+    node->value = glyph;
+
+    // Readers on other threads only find the entry once it is filled in
+    if(*entry == 0)
+    {
+        FC_STORE_RELEASE(&map->count, number);
+        FC_STORE_RELEASE(entry, number);
     }
 
-    return NULL;
+    if(codepoint < FC_MAP_ASCII_END)
+        FC_STORE_RELEASE(&map->ascii_glyphs[codepoint], &node->value);
+
+    return &node->value;
 }
 
 static FC_GlyphData* FC_MapFind(FC_Map* map, Uint32 codepoint)
 {
-    Uint32 index;
-    FC_MapNode* node;
+    Uint32* entry;
+    Uint32 number;
     if(map == NULL)
         return NULL;
 
-    // Get index for bucket
-    index = codepoint % map->num_buckets;
-
-    // Go through list until we find a match
-    for(node = map->buckets[index]; node != NULL; node = node->next)
-    {
-        if(node->key == codepoint)
-            return &node->value;
-    }
+    entry = FC_MapLocate(map, codepoint, 0);
+    number = (entry == NULL)? 0 : FC_LOAD_ACQUIRE(entry);
+    if(number == 0)
+        return NULL;
 
-    return NULL;
+    return &FC_MapGetEntry(map, number)->value;
 }
 
 
 
+// Assume this many will be enough...
+#define FC_LOAD_MAX_SURFACES 10
+
 struct FC_Font
 {
     #ifndef FC_USE_SDL_GPU
@@ -452,6 +596,14 @@ struct FC_Font
 
     char* loading_string;
 
+    // The thread that uploads the cache; only it may rasterise glyphs that are missing from the map
+    SDL_threadID render_thread;
+
+    // Cache levels rasterised by FC_PrepareFontFromTTF() that FC_UploadPreparedGlyphCache() has not uploaded yet
+    SDL_Surface* prepared_surfaces[FC_LOAD_MAX_SURFACES];
+    int num_prepared_surfaces;
+    int num_uploaded_surfaces;
+
 };
 
 // Private
@@ -768,6 +920,63 @@ void FC_GetUTF8FromCodepoint(char* result, Uint32 codepoint)
     }
 }
 
+// FC_GetASCIIRunLength() a word at a time, for targets without SSE2 (the Switch among them).  Built everywhere so
+// the host checks can run it.
+static_inline size_t FC_GetASCIIRunLengthWords(const char* text)
+{
+    const unsigned char* c = (const unsigned char*)text;
+
+    for(; ((size_t)c & 7) != 0; ++c)
+    {
+        if(*c == '\0' || *c >= 0x80)
+            return c - (const unsigned char*)text;
+    }
+
+    #if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    for(; ; c += 8)
+    {
+        // High bits flag bytes from 0x80 up; the borrow trick flags zero bytes.  The borrow can also flag bytes
+        // after a zero byte, but never before the first one, so the lowest flag is always the right one.
+        Uint64 word, stop;
+        memcpy(&word, c, 8);
+        stop = (word | ((word - 0x0101010101010101ULL) & ~word)) & 0x8080808080808080ULL;
+        if(stop != 0)
+            return c + __builtin_ctzll(stop) / 8 - (const unsigned char*)text;
+    }
+    #else
+    for(; *c != '\0' && *c < 0x80; ++c)
+        ;
+    return c - (const unsigned char*)text;
+    #endif
+}
+
+// Returns how many bytes from 'text' are ASCII, stopping at the first NUL or byte of a multibyte sequence.  Loads are
+// aligned to their own size, so like strlen() they may read past the terminator but never into the next page.
+static size_t FC_GetASCIIRunLength(const char* text)
+{
+    #if defined(FC_SCAN_SSE2)
+    const unsigned char* c = (const unsigned char*)text;
+    const unsigned char* block;
+
+    for(; ((size_t)c & 15) != 0; ++c)
+    {
+        if(*c == '\0' || *c >= 0x80)
+            return c - (const unsigned char*)text;
+    }
+
+    for(block = c; ; block += 16)
+    {
+        // A byte stops the run if its top bit is set or it is zero
+        __m128i bytes = _mm_load_si128((const __m128i*)block);
+        int stop = _mm_movemask_epi8(_mm_or_si128(bytes, _mm_cmpeq_epi8(bytes, _mm_setzero_si128())));
+        if(stop != 0)
+            return block + __builtin_ctz(stop) - (const unsigned char*)text;
+    }
+    #else
+    return FC_GetASCIIRunLengthWords(text);
+    #endif
+}
+
 Uint32 FC_GetCodepointFromUTF8(const char** c, Uint8 advance_pointer)
 {
     Uint32 result = 0;
@@ -823,14 +1032,17 @@ unsigned int FC_GetBufferSize(void)
 
 void FC_SetBufferSize(unsigned int size)
 {
-    free(fc_buffer);
     if(size > 0)
-    {
         fc_buffer_size = size;
-        fc_buffer = (char*)malloc(fc_buffer_size);
-    }
-    else
-        fc_buffer = (char*)malloc(fc_buffer_size);
+
+    FC_ReserveBuffer();
+}
+
+void FC_FreeBuffer(void)
+{
+    free(fc_buffer);
+    fc_buffer = NULL;
+    fc_thread_buffer_size = 0;
 }
 
 
@@ -859,6 +1071,8 @@ static void FC_Init(FC_Font* font)
     font->renderer = NULL;
     #endif
 
+    font->render_thread = SDL_ThreadID();
+
     font->ttf_source = NULL;
     font->owns_ttf_source = 0;
 
@@ -889,7 +1103,7 @@ static void FC_Init(FC_Font* font)
     if(font->glyphs != NULL)
         FC_MapFree(font->glyphs);
 
-    font->glyphs = FC_MapCreate(FC_DEFAULT_NUM_BUCKETS);
+    font->glyphs = FC_MapCreate();
 
     font->glyph_cache_size = 3;
     font->glyph_cache_count = 0;
@@ -900,8 +1114,7 @@ static void FC_Init(FC_Font* font)
 	if (font->loading_string == NULL)
 		font->loading_string = FC_GetStringASCII();
 
-    if(fc_buffer == NULL)
-        fc_buffer = (char*)malloc(fc_buffer_size);
+    FC_ReserveBuffer();
 }
 
 static Uint8 FC_GrowGlyphCache(FC_Font* font)
@@ -1163,36 +1376,13 @@ FC_Font* FC_CreateFont(void)
 }
 
 
-// Assume this many will be enough...
-#define FC_LOAD_MAX_SURFACES 10
-
-#ifdef FC_USE_SDL_GPU
-Uint8 FC_LoadFontFromTTF(FC_Font* font, TTF_Font* ttf, SDL_Color color)
-#else
-Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, SDL_Color color)
-#endif
+Uint8 FC_PrepareFontFromTTF(FC_Font* font, TTF_Font* ttf, SDL_Color color)
 {
     if(font == NULL || ttf == NULL)
         return 0;
-    #ifndef FC_USE_SDL_GPU
-    if(renderer == NULL)
-        return 0;
-    #endif
 
     FC_ClearFont(font);
 
-
-    // Might as well check render target support here
-    #ifdef FC_USE_SDL_GPU
-    fc_has_render_target_support = GPU_IsFeatureEnabled(GPU_FEATURE_RENDER_TARGETS);
-    #else
-    SDL_RendererInfo info;
-    SDL_GetRendererInfo(renderer, &info);
-    fc_has_render_target_support = (info.flags & SDL_RENDERER_TARGETTEXTURE);
-
-    font->renderer = renderer;
-    #endif
-
     font->ttf_source = ttf;
 
     //font->line_height = TTF_FontLineSkip(ttf);
@@ -1221,7 +1411,7 @@ Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, S
         // Try figuring out dimensions that make sense for the font size.
         unsigned int w = font->height*12;
         unsigned int h = font->height*12;
-        SDL_Surface* surfaces[FC_LOAD_MAX_SURFACES];
+        SDL_Surface** surfaces = font->prepared_surfaces;
         int num_surfaces = 1;
         surfaces[0] = FC_CreateSurface32(w, h);
         font->last_glyph.rect.x = FC_CACHE_PADDING;
@@ -1243,7 +1433,6 @@ Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, S
             packed = (FC_PackGlyphData(font, FC_GetCodepointFromUTF8(&buff_ptr, 0), glyph_surf->w, surfaces[num_surfaces-1]->w, surfaces[num_surfaces-1]->h) != NULL);
             if(!packed)
             {
-                int i = num_surfaces-1;
                 if(num_surfaces >= FC_LOAD_MAX_SURFACES)
                 {
                     // Can't do any more!
@@ -1252,16 +1441,9 @@ Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, S
                     break;
                 }
 
-                // Upload the current surface to the glyph cache now so we can keep the cache level packing cursor up to date as we go.
-                FC_UploadGlyphCache(font, i, surfaces[i]);
-                SDL_FreeSurface(surfaces[i]);
-                #ifndef FC_USE_SDL_GPU
-                SDL_SetTextureBlendMode(font->glyph_cache[i], SDL_BLENDMODE_BLEND);
-                #endif
-                // Update the glyph cursor to the new cache level.  We need to do this here because the actual cache lags behind our use of the packing above.
+                // Update the glyph cursor to the new cache level.  Its texture is uploaded along with the others later.
                 font->last_glyph.cache_level = num_surfaces;
 
-
                 surfaces[num_surfaces] = FC_CreateSurface32(w, h);
                 num_surfaces++;
             }
@@ -1278,16 +1460,288 @@ Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, S
             SDL_FreeSurface(glyph_surf);
         }
 
+        font->num_prepared_surfaces = num_surfaces;
+        font->num_uploaded_surfaces = 0;
+    }
+
+    return 1;
+}
+
+#ifdef FC_USE_SDL_GPU
+int FC_UploadPreparedGlyphCache(FC_Font* font)
+#else
+int FC_UploadPreparedGlyphCache(FC_Font* font, SDL_Renderer* renderer)
+#endif
+{
+    int i;
+    if(font == NULL)
+        return 0;
+    #ifndef FC_USE_SDL_GPU
+    if(renderer == NULL)
+        return font->num_prepared_surfaces - font->num_uploaded_surfaces;
+    #endif
+
+    if(font->num_uploaded_surfaces == 0)
+    {
+        font->render_thread = SDL_ThreadID();
+
+        // Might as well check render target support here
+        #ifdef FC_USE_SDL_GPU
+        fc_has_render_target_support = GPU_IsFeatureEnabled(GPU_FEATURE_RENDER_TARGETS);
+        #else
+        SDL_RendererInfo info;
+        SDL_GetRendererInfo(renderer, &info);
+        fc_has_render_target_support = (info.flags & SDL_RENDERER_TARGETTEXTURE);
+
+        font->renderer = renderer;
+        #endif
+    }
+
+    if(font->num_uploaded_surfaces < font->num_prepared_surfaces)
+    {
+        i = font->num_uploaded_surfaces++;
+        FC_UploadGlyphCache(font, i, font->prepared_surfaces[i]);
+        SDL_FreeSurface(font->prepared_surfaces[i]);
+        font->prepared_surfaces[i] = NULL;
+        #ifndef FC_USE_SDL_GPU
+        SDL_SetTextureBlendMode(font->glyph_cache[i], SDL_BLENDMODE_BLEND);
+        #endif
+    }
+
+    return font->num_prepared_surfaces - font->num_uploaded_surfaces;
+}
+
+#ifdef FC_USE_SDL_GPU
+Uint8 FC_LoadFontFromTTF(FC_Font* font, TTF_Font* ttf, SDL_Color color)
+#else
+Uint8 FC_LoadFontFromTTF(FC_Font* font, SDL_Renderer* renderer, TTF_Font* ttf, SDL_Color color)
+#endif
+{
+    #ifndef FC_USE_SDL_GPU
+    if(renderer == NULL)
+        return 0;
+    #endif
+
+    if(!FC_PrepareFontFromTTF(font, ttf, color))
+        return 0;
+
+    #ifdef FC_USE_SDL_GPU
+    while(FC_UploadPreparedGlyphCache(font) > 0);
+    #else
+    while(FC_UploadPreparedGlyphCache(font, renderer) > 0);
+    #endif
+
+    return 1;
+}
+
+
+// Glyph cache files: every field is a little-endian Uint32.
+//   header:  magic, version, font hash (low, high), point size, height, ascent, descent, baseline,
+//            packing cursor (cache level, x, y, w, h), number of cache levels, number of glyphs
+//   glyphs:  codepoint, cache level, x, y, w, h
+//   levels:  width, height, then width*height RGBA32 pixels
+#define FC_GLYPH_CACHE_MAGIC 0x43474346  // "FCGC"
+#define FC_GLYPH_CACHE_VERSION 1
+#define FC_GLYPH_CACHE_MAX_SIZE 8192  // Largest level, in pixels each way, that a cache file may hold
+
+static Uint8 FC_WriteGlyphCache(FC_Font* font, SDL_RWops* dest, Uint64 font_hash, Uint32 point_size, SDL_Surface** levels, int num_levels)
+{
+    Uint32 i;
+    int level, row;
+    Uint32 header[16];
+    if(font == NULL || dest == NULL || font->glyphs == NULL)
+        return 0;
+
+    header[0] = FC_GLYPH_CACHE_MAGIC;
+    header[1] = FC_GLYPH_CACHE_VERSION;
+    header[2] = (Uint32)font_hash;
+    header[3] = (Uint32)(font_hash >> 32);
+    header[4] = point_size;
+    header[5] = font->height;
+    header[6] = font->ascent;
+    header[7] = font->descent;
+    header[8] = font->baseline;
+    header[9] = font->last_glyph.cache_level;
+    header[10] = font->last_glyph.rect.x;
+    header[11] = font->last_glyph.rect.y;
+    header[12] = font->last_glyph.rect.w;
+    header[13] = font->last_glyph.rect.h;
+    header[14] = num_levels;
+    header[15] = font->glyphs->count;
+
+    for(i = 0; i < 16; ++i)
+    {
+        if(!SDL_WriteLE32(dest, header[i]))
+            return 0;
+    }
+
+    for(i = 1; i <= font->glyphs->count; ++i)
+    {
+        FC_MapEntry* entry = FC_MapGetEntry(font->glyphs, i);
+        if(!SDL_WriteLE32(dest, entry->key) || !SDL_WriteLE32(dest, entry->value.cache_level) ||
+           !SDL_WriteLE32(dest, entry->value.rect.x) || !SDL_WriteLE32(dest, entry->value.rect.y) ||
+           !SDL_WriteLE32(dest, entry->value.rect.w) || !SDL_WriteLE32(dest, entry->value.rect.h))
+            return 0;
+    }
+
+    for(level = 0; level < num_levels; ++level)
+    {
+        SDL_Surface* surface = levels[level];
+        if(!SDL_WriteLE32(dest, surface->w) || !SDL_WriteLE32(dest, surface->h))
+            return 0;
+
+        for(row = 0; row < surface->h; ++row)
+        {
+            if(SDL_RWwrite(dest, (Uint8*)surface->pixels + row*surface->pitch, surface->w*4, 1) != 1)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+Uint8 FC_WritePreparedFont(FC_Font* font, SDL_RWops* dest, Uint64 font_hash, Uint32 point_size)
+{
+    if(font == NULL || font->num_uploaded_surfaces != 0 || font->num_prepared_surfaces == 0)
+        return 0;
+
+    return FC_WriteGlyphCache(font, dest, font_hash, point_size, font->prepared_surfaces, font->num_prepared_surfaces);
+}
+
+Uint8 FC_SaveGlyphCache(FC_Font* font, SDL_RWops* dest, Uint64 font_hash, Uint32 point_size)
+{
+    SDL_Surface* levels[FC_LOAD_MAX_SURFACES];
+    int num_levels, i;
+    Uint8 result = 1;
+    #ifndef FC_USE_SDL_GPU
+    SDL_Texture* prev_target;
+    #endif
+    if(font == NULL || font->glyph_cache_count == 0 || font->glyph_cache_count > FC_LOAD_MAX_SURFACES ||
+       font->num_uploaded_surfaces != font->num_prepared_surfaces)
+        return 0;
+
+    #ifdef FC_USE_SDL_GPU
+    for(num_levels = 0; result && num_levels < font->glyph_cache_count; ++num_levels)
+    {
+        levels[num_levels] = GPU_CopySurfaceFromImage(font->glyph_cache[num_levels]);
+        result = (levels[num_levels] != NULL);
+    }
+    #else
+    // Levels are only readable as render targets.
+    if(font->renderer == NULL || !fc_has_render_target_support)
+        return 0;
+
+    prev_target = SDL_GetRenderTarget(font->renderer);
+    for(num_levels = 0; result && num_levels < font->glyph_cache_count; ++num_levels)
+    {
+        int w = 0, h = 0;
+        SDL_QueryTexture(font->glyph_cache[num_levels], NULL, NULL, &w, &h);
+        levels[num_levels] = FC_CreateSurface32(w, h);
+        result = (levels[num_levels] != NULL && SDL_SetRenderTarget(font->renderer, font->glyph_cache[num_levels]) == 0 &&
+                  SDL_RenderReadPixels(font->renderer, NULL, levels[num_levels]->format->format, levels[num_levels]->pixels, levels[num_levels]->pitch) == 0);
+    }
+    SDL_SetRenderTarget(font->renderer, prev_target);
+    #endif
+
+    if(result)
+        result = FC_WriteGlyphCache(font, dest, font_hash, point_size, levels, num_levels);
+
+    for(i = 0; i < num_levels; ++i)
+        SDL_FreeSurface(levels[i]);
+
+    return result;
+}
+
+// Whether a glyph or packing cursor read from a cache file lies within the level it points into.
+static_inline Uint8 FC_GlyphFitsLevel(const FC_GlyphData* glyph, SDL_Surface** levels, Uint32 num_levels)
+{
+    SDL_Surface* surface;
+    if(glyph->cache_level < 0 || (Uint32)glyph->cache_level >= num_levels)
+        return 0;
+
+    surface = levels[glyph->cache_level];
+    return (glyph->rect.x >= 0 && glyph->rect.y >= 0 && glyph->rect.x + glyph->rect.w <= surface->w && glyph->rect.y + glyph->rect.h <= surface->h);
+}
+
+Uint8 FC_PrepareFontFromCache(FC_Font* font, SDL_RWops* src, TTF_Font* ttf, Uint64 font_hash, Uint32 point_size, SDL_Color color)
+{
+    Uint32 i;
+    Uint32 header[16];
+    int level, row;
+    if(font == NULL || src == NULL)
+        return 0;
+
+    for(i = 0; i < 16; ++i)
+        header[i] = SDL_ReadLE32(src);
+
+    if(header[0] != FC_GLYPH_CACHE_MAGIC || header[1] != FC_GLYPH_CACHE_VERSION || header[2] != (Uint32)font_hash ||
+       header[3] != (Uint32)(font_hash >> 32) || header[4] != point_size || header[14] == 0 || header[14] > FC_LOAD_MAX_SURFACES ||
+       header[9] >= header[14] || header[10] > FC_GLYPH_CACHE_MAX_SIZE || header[11] > FC_GLYPH_CACHE_MAX_SIZE ||
+       header[12] > FC_GLYPH_CACHE_MAX_SIZE || header[13] > FC_GLYPH_CACHE_MAX_SIZE)
+        return 0;
+
+    FC_ClearFont(font);
+
+    font->ttf_source = ttf;
+    font->height = header[5];
+    font->ascent = header[6];
+    font->descent = header[7];
+    font->baseline = header[8];
+    font->default_color = color;
+    font->last_glyph = FC_MakeGlyphData(header[9], header[10], header[11], header[12], header[13]);
+
+    for(i = 0; i < header[15]; ++i)
+    {
+        Uint32 codepoint = SDL_ReadLE32(src);
+        Uint32 cache_level = SDL_ReadLE32(src);
+        Uint32 x = SDL_ReadLE32(src);
+        Uint32 y = SDL_ReadLE32(src);
+        Uint32 w = SDL_ReadLE32(src);
+        Uint32 h = SDL_ReadLE32(src);
+
+        // Each value has to fit a level before it is narrowed; whether it fits its own level is checked below
+        if(cache_level >= header[14] || x > FC_GLYPH_CACHE_MAX_SIZE || y > FC_GLYPH_CACHE_MAX_SIZE || w > FC_GLYPH_CACHE_MAX_SIZE ||
+           h > FC_GLYPH_CACHE_MAX_SIZE || FC_MapInsert(font->glyphs, codepoint, FC_MakeGlyphData(cache_level, x, y, w, h)) == NULL)
         {
-            int i = num_surfaces-1;
-            FC_UploadGlyphCache(font, i, surfaces[i]);
-            SDL_FreeSurface(surfaces[i]);
-            #ifndef FC_USE_SDL_GPU
-            SDL_SetTextureBlendMode(font->glyph_cache[i], SDL_BLENDMODE_BLEND);
-            #endif
+            FC_ClearFont(font);
+            return 0;
         }
     }
 
+    for(level = 0; level < (int)header[14]; ++level)
+    {
+        Uint32 w = SDL_ReadLE32(src);
+        Uint32 h = SDL_ReadLE32(src);
+        SDL_Surface* surface = (w > 0 && w <= FC_GLYPH_CACHE_MAX_SIZE && h > 0 && h <= FC_GLYPH_CACHE_MAX_SIZE)? FC_CreateSurface32(w, h) : NULL;
+
+        font->prepared_surfaces[level] = surface;
+        font->num_prepared_surfaces = level + 1;
+
+        for(row = 0; surface != NULL && row < surface->h; ++row)
+        {
+            if(SDL_RWread(src, (Uint8*)surface->pixels + row*surface->pitch, surface->w*4, 1) != 1)
+                surface = NULL;
+        }
+
+        if(surface == NULL)
+        {
+            FC_ClearFont(font);
+            return 0;
+        }
+    }
+
+    // A stale or corrupt file could otherwise point the packer or the renderer outside a level
+    for(i = 0; i <= font->glyphs->count; ++i)
+    {
+        const FC_GlyphData* glyph = (i == 0)? &font->last_glyph : &FC_MapGetEntry(font->glyphs, i)->value;
+        if(!FC_GlyphFitsLevel(glyph, font->prepared_surfaces, header[14]))
+        {
+            FC_ClearFont(font);
+            return 0;
+        }
+    }
+
+    font->num_uploaded_surfaces = 0;
     return 1;
 }
 
@@ -1433,6 +1887,11 @@ void FC_ClearFont(FC_Font* font)
     free(font->glyph_cache);
     font->glyph_cache = NULL;
 
+    for(i = font->num_uploaded_surfaces; i < font->num_prepared_surfaces; ++i)
+        SDL_FreeSurface(font->prepared_surfaces[i]);
+    font->num_prepared_surfaces = 0;
+    font->num_uploaded_surfaces = 0;
+
     // Reset font
     FC_Init(font);
 }
@@ -1462,6 +1921,9 @@ void FC_FreeFont(FC_Font* font)
     }
     free(font->glyph_cache);
 
+    for(i = font->num_uploaded_surfaces; i < font->num_prepared_surfaces; ++i)
+        SDL_FreeSurface(font->prepared_surfaces[i]);
+
     free(font->loading_string);
 
     free(font);
@@ -1478,8 +1940,7 @@ void FC_FreeFont(FC_Font* font)
         free(ASCII_LATIN_1_STRING);
         ASCII_LATIN_1_STRING = NULL;
 
-        free(fc_buffer);
-        fc_buffer = NULL;
+        FC_FreeBuffer();
     }
 }
 
@@ -1561,45 +2022,21 @@ Uint8 FC_AddGlyphToCache(FC_Font* font, SDL_Surface* glyph_surface)
 
 unsigned int FC_GetNumCodepoints(FC_Font* font)
 {
-    FC_Map* glyphs;
-    int i;
-    unsigned int result = 0;
     if(font == NULL || font->glyphs == NULL)
         return 0;
 
-    glyphs = font->glyphs;
-
-    for(i = 0; i < glyphs->num_buckets; ++i)
-    {
-        FC_MapNode* node;
-        for(node = glyphs->buckets[i]; node != NULL; node = node->next)
-        {
-            result++;
-        }
-    }
-
-    return result;
+    return FC_LOAD_ACQUIRE(&font->glyphs->count);
 }
 
 void FC_GetCodepoints(FC_Font* font, Uint32* result)
 {
-    FC_Map* glyphs;
-    int i;
-    unsigned int count = 0;
+    Uint32 i;
     if(font == NULL || font->glyphs == NULL)
         return;
 
-    glyphs = font->glyphs;
-
-    for(i = 0; i < glyphs->num_buckets; ++i)
-    {
-        FC_MapNode* node;
-        for(node = glyphs->buckets[i]; node != NULL; node = node->next)
-        {
-            result[count] = node->key;
-            count++;
-        }
-    }
+    // In insertion order
+    for(i = 1; i <= font->glyphs->count; ++i)
+        result[i - 1] = FC_MapGetEntry(font->glyphs, i)->key;
 }
 
 Uint8 FC_GetGlyphData(FC_Font* font, FC_GlyphData* result, Uint32 codepoint)
@@ -1613,7 +2050,7 @@ Uint8 FC_GetGlyphData(FC_Font* font, FC_GlyphData* result, Uint32 codepoint)
         SDL_Surface* surf;
         FC_Image* cache_image;
 
-        if(font->ttf_source == NULL)
+        if(font->ttf_source == NULL || SDL_ThreadID() != font->render_thread)
             return 0;
 
         FC_GetUTF8FromCodepoint(buff, codepoint);
@@ -1666,6 +2103,18 @@ Uint8 FC_GetGlyphData(FC_Font* font, FC_GlyphData* result, Uint32 codepoint)
 }
 
 
+// FC_GetGlyphData() with ASCII glyphs that are already cached read straight from the map's pointer table.
+static_inline Uint8 FC_GetGlyphDataFast(FC_Font* font, FC_GlyphData* result, Uint32 codepoint)
+{
+    FC_GlyphData* known = (codepoint < FC_MAP_ASCII_END && font->glyphs != NULL)? FC_LOAD_ACQUIRE(&font->glyphs->ascii_glyphs[codepoint]) : NULL;
+    if(known == NULL)
+        return FC_GetGlyphData(font, result, codepoint);
+
+    *result = *known;
+    return 1;
+}
+
+
 FC_GlyphData* FC_SetGlyphData(FC_Font* font, Uint32 codepoint, FC_GlyphData glyph_data)
 {
     return FC_MapInsert(font->glyphs, codepoint, glyph_data);
@@ -1677,6 +2126,7 @@ FC_GlyphData* FC_SetGlyphData(FC_Font* font, Uint32 codepoint, FC_GlyphData glyp
 static FC_Rect FC_RenderLeft(FC_Font* font, FC_Target* dest, float x, float y, FC_Scale scale, const char* text)
 {
     const char* c = text;
+    const char* ascii_end = text;
     FC_Rect srcRect;
     FC_Rect dstRect;
     FC_Rect dirtyRect = FC_MakeRect(x, y, 0, 0);
@@ -1711,11 +2161,18 @@ static FC_Rect FC_RenderLeft(FC_Font* font, FC_Target* dest, float x, float y, F
             continue;
         }
 
-        codepoint = FC_GetCodepointFromUTF8(&c, 1);  // Increments 'c' to skip the extra UTF-8 bytes
-        if(!FC_GetGlyphData(font, &glyph, codepoint))
+        // Bytes inside a run of ASCII are their own codepoints; the rest are decoded
+        if(c >= ascii_end)
+            ascii_end = c + FC_GetASCIIRunLength(c);
+        if(c < ascii_end)
+            codepoint = (unsigned char)*c;
+        else
+            codepoint = FC_GetCodepointFromUTF8(&c, 1);  // Increments 'c' to skip the extra UTF-8 bytes
+
+        if(!FC_GetGlyphDataFast(font, &glyph, codepoint))
         {
             codepoint = ' ';
-            if(!FC_GetGlyphData(font, &glyph, codepoint))
+            if(!FC_GetGlyphDataFast(font, &glyph, codepoint))
                 continue;  // Skip bad characters
         }
 
@@ -2435,6 +2892,16 @@ FC_Rect FC_DrawColor(FC_Font* font, FC_Target* dest, float x, float y, SDL_Color
     return FC_RenderLeft(font, dest, x, y, FC_MakeScale(1,1), fc_buffer);
 }
 
+FC_Rect FC_DrawColorUnformatted(FC_Font* font, FC_Target* dest, float x, float y, SDL_Color color, const char* text)
+{
+    if(text == NULL || font == NULL)
+        return FC_MakeRect(x, y, 0, 0);
+
+    set_color_for_all_caches(font, color);
+
+    return FC_RenderLeft(font, dest, x, y, FC_MakeScale(1,1), text);
+}
+
 
 FC_Rect FC_DrawEffect(FC_Font* font, FC_Target* dest, float x, float y, FC_Effect effect, const char* formatted_text, ...)
 {
@@ -2494,10 +2961,18 @@ Uint16 FC_GetHeight(FC_Font* font, const char* formatted_text, ...)
 
     FC_EXTRACT_VARARGS(fc_buffer, formatted_text);
 
+    return FC_GetHeightUnformatted(font, fc_buffer);
+}
+
+Uint16 FC_GetHeightUnformatted(FC_Font* font, const char* text)
+{
+    if(text == NULL || font == NULL)
+        return 0;
+
     Uint16 numLines = 1;
     const char* c;
 
-    for (c = fc_buffer; *c != '\0'; c++)
+    for (c = text; *c != '\0'; c++)
     {
         if(*c == '\n')
             numLines++;
@@ -2514,11 +2989,28 @@ Uint16 FC_GetWidth(FC_Font* font, const char* formatted_text, ...)
 
     FC_EXTRACT_VARARGS(fc_buffer, formatted_text);
 
+    return FC_GetWidthUnformatted(font, fc_buffer);
+}
+
+Uint16 FC_GetWidthUnformatted(FC_Font* font, const char* text)
+{
+    return FC_GetWidthUnformattedComplete(font, text, NULL);
+}
+
+Uint16 FC_GetWidthUnformattedComplete(FC_Font* font, const char* text, Uint8* complete)
+{
+    if(complete != NULL)
+        *complete = 1;
+
+    if(text == NULL || font == NULL)
+        return 0;
+
     const char* c;
+    const char* ascii_end = text;
     Uint16 width = 0;
     Uint16 bigWidth = 0;  // Allows for multi-line strings
 
-    for (c = fc_buffer; *c != '\0'; c++)
+    for (c = text; *c != '\0'; c++)
     {
         if(*c == '\n')
         {
@@ -2528,9 +3020,21 @@ Uint16 FC_GetWidth(FC_Font* font, const char* formatted_text, ...)
         }
 
         FC_GlyphData glyph;
-        Uint32 codepoint = FC_GetCodepointFromUTF8(&c, 1);
-        if(FC_GetGlyphData(font, &glyph, codepoint) || FC_GetGlyphData(font, &glyph, ' '))
+        Uint32 codepoint;
+        if(c >= ascii_end)
+            ascii_end = c + FC_GetASCIIRunLength(c);
+        codepoint = (c < ascii_end)? (unsigned char)*c : FC_GetCodepointFromUTF8(&c, 1);
+
+        if(FC_GetGlyphDataFast(font, &glyph, codepoint))
             width += glyph.rect.w;
+        else
+        {
+            // Not cached and can't be added from this thread, so it stands in as a space
+            if(complete != NULL)
+                *complete = 0;
+            if(FC_GetGlyphDataFast(font, &glyph, ' '))
+                width += glyph.rect.w;
+        }
     }
     bigWidth = bigWidth >= width? bigWidth : width;
 
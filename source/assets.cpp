@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "assets.hpp"
+
+namespace Assets {
+    // On-disk layout, little-endian, as written by tools/pack_atlas.py.
+    struct BundleHeader {
+        char magic[4]; // "SIAB"
+        u32 version;
+        u32 count;
+        u32 reserved;
+    };
+
+    struct BundleEntry {
+        char name[24];
+        u32 format;
+        u32 width;
+        u32 height;
+        u32 pitch;
+        u32 offset; // From the start of the file.
+        u32 size;   // Of the decoded pixels.
+        u32 stored_size; // Of the LZ4 block at `offset`.
+    };
+
+    static const u32 g_bundle_version = 2;
+    static const int g_max_images = 16;
+
+    static u8 *g_data = nullptr;
+    static u8 *g_pixels = nullptr;
+    static Image g_images[g_max_images];
+    static int g_image_count = 0;
+
+    void *ReadFile(const char *path, size_t *size) {
+        FILE *file = std::fopen(path, "rb");
+        if (file == nullptr)
+            return nullptr;
+
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+
+        void *data = (length > 0)? std::malloc(length) : nullptr;
+        if ((data != nullptr) && (std::fread(data, 1, length, file) != static_cast<size_t>(length))) {
+            std::free(data);
+            data = nullptr;
+        }
+
+        std::fclose(file);
+        *size = (data != nullptr)? length : 0;
+        return data;
+    }
+
+    u64 Hash(const void *data, size_t size) {
+        u64 hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ static_cast<const u8 *>(data)[i]) * 0x100000001B3ULL;
+
+        return hash;
+    }
+
+    u64 HashFont(const void *data, size_t size) {
+        const u8 *bytes = static_cast<const u8 *>(data);
+
+        // An sfnt starts with a 12-byte offset table, whose numTables (big-endian, at 4) counts the 16-byte table
+        // records after it. Anything else, collections included, is hashed whole.
+        size_t length = size;
+        if ((size >= 12) && (std::memcmp(bytes, "ttcf", 4) != 0))
+            length = std::min<size_t>(size, 12 + (16 * ((bytes[4] << 8) | bytes[5])));
+
+        return Assets::Hash(bytes, length) ^ (static_cast<u64>(size) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    static bool ReadLength(const u8 **src, const u8 *src_end, size_t *length) {
+        u8 byte = 255;
+        while (byte == 255) {
+            if (*src >= src_end)
+                return false;
+
+            byte = *(*src)++;
+            *length += byte;
+        }
+
+        return true;
+    }
+
+    // Decodes one raw LZ4 block (no frame) as written by tools/pack_atlas.py. Fails unless it decodes to exactly
+    // `dst_size` bytes without reading or writing out of bounds.
+    static bool DecompressLZ4(const u8 *src, size_t src_size, u8 *dst, size_t dst_size) {
+        const u8 *src_end = src + src_size;
+        u8 *out = dst, *dst_end = dst + dst_size;
+
+        while (src < src_end) {
+            u8 token = *src++;
+
+            size_t length = token >> 4;
+            if ((length == 15) && !Assets::ReadLength(&src, src_end, &length))
+                return false;
+
+            if ((static_cast<size_t>(src_end - src) < length) || (static_cast<size_t>(dst_end - out) < length))
+                return false;
+
+            std::memcpy(out, src, length);
+            src += length;
+            out += length;
+
+            // Only the last sequence ends without a match.
+            if (src == src_end)
+                break;
+
+            if ((src_end - src) < 2)
+                return false;
+
+            size_t offset = src[0] | (src[1] << 8);
+            src += 2;
+            if ((offset == 0) || (offset > static_cast<size_t>(out - dst)))
+                return false;
+
+            length = (token & 0xF);
+            if ((length == 15) && !Assets::ReadLength(&src, src_end, &length))
+                return false;
+
+            length += 4;
+            if (static_cast<size_t>(dst_end - out) < length)
+                return false;
+
+            // A match may overlap what it writes (a run of transparent pixels is one long match at a short offset);
+            // copying in chunks of the distance so far doubles each chunk instead of going byte by byte.
+            const u8 *match = out - offset;
+            while (length > 0) {
+                size_t chunk = std::min(length, static_cast<size_t>(out - match));
+                std::memcpy(out, match, chunk);
+                out += chunk;
+                length -= chunk;
+            }
+        }
+
+        return out == dst_end;
+    }
+
+    int Load(const char *path) {
+        Assets::Free();
+
+        size_t size = 0;
+        g_data = static_cast<u8 *>(Assets::ReadFile(path, &size));
+
+        const BundleHeader *header = reinterpret_cast<const BundleHeader *>(g_data);
+        if ((size < sizeof(BundleHeader)) || (std::memcmp(header->magic, "SIAB", 4) != 0) || (header->version != g_bundle_version) ||
+            (sizeof(BundleHeader) + (static_cast<u64>(header->count) * sizeof(BundleEntry)) > static_cast<u64>(size))) {
+            Assets::Free();
+            return -1;
+        }
+
+        // Every image decodes into one allocation, each starting 16-byte aligned.
+        const BundleEntry *entries = reinterpret_cast<const BundleEntry *>(g_data + sizeof(BundleHeader));
+        u64 pixels_size = 0;
+        for (u32 i = 0; i < header->count; i++)
+            pixels_size += (static_cast<u64>(entries[i].size) + 15) & ~15ULL;
+
+        g_pixels = static_cast<u8 *>(std::malloc(pixels_size));
+        if (g_pixels == nullptr) {
+            Assets::Free();
+            return -1;
+        }
+
+        u8 *pixels = g_pixels;
+        for (u32 i = 0; (i < header->count) && (g_image_count < g_max_images); i++) {
+            const BundleEntry *entry = &entries[i];
+
+            if ((entry->name[sizeof(entry->name) - 1] != '\0') || (static_cast<u64>(entry->offset) + entry->stored_size > static_cast<u64>(size)) ||
+                (static_cast<u64>(entry->pitch) * entry->height > entry->size) ||
+                !Assets::DecompressLZ4(g_data + entry->offset, entry->stored_size, pixels, entry->size))
+                continue;
+
+            Image *image = &g_images[g_image_count++];
+            image->name = entry->name;
+            image->format = entry->format;
+            image->width = entry->width;
+            image->height = entry->height;
+            image->pitch = entry->pitch;
+            image->pixels = pixels;
+            pixels += (entry->size + 15) & ~15U;
+        }
+
+        return 0;
+    }
+
+    const Image *Find(const char *name) {
+        for (int i = 0; i < g_image_count; i++) {
+            if (std::strcmp(g_images[i].name, name) == 0)
+                return &g_images[i];
+        }
+
+        return nullptr;
+    }
+
+    void Free(void) {
+        std::free(g_data);
+        std::free(g_pixels);
+        g_data = nullptr;
+        g_pixels = nullptr;
+        g_image_count = 0;
+    }
+}
@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <thread>
+
+#include "events.hpp"
+#include "sampler.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+
+namespace Events {
+    static const int g_max_waiters = 4;
+
+    static std::thread g_thread;
+    static UEvent g_exit_event;
+
+    static PsmSession g_psm_session;
+    static bool g_psm_bound = false;
+    static FsEventNotifier g_sd_notifier, g_gamecard_notifier;
+    static Event g_sd_event, g_gamecard_event;
+    static bool g_sd_open = false, g_gamecard_open = false;
+
+    static Waiter g_waiters[g_max_waiters];
+    static Event *g_waiter_events[g_max_waiters];
+    static u32 g_waiter_masks[g_max_waiters];
+    static int g_waiter_count = 0;
+
+    static void AddWaiter(Waiter waiter, Event *event, u32 mask) {
+        g_waiters[g_waiter_count] = waiter;
+        g_waiter_events[g_waiter_count] = event;
+        g_waiter_masks[g_waiter_count] = mask;
+        g_waiter_count++;
+    }
+
+    static bool OpenFsNotifier(Result (*open)(FsEventNotifier *), FsEventNotifier *notifier, Event *event, const char *name) {
+        Result ret = 0;
+
+        if (R_FAILED(ret = open(notifier))) {
+            std::printf("%s() failed: 0x%x.\n\n", name, ret);
+            return false;
+        }
+
+        if (R_FAILED(ret = STATS_CALL(fsEventNotifierGetEventHandle, notifier, event, true))) {
+            std::printf("fsEventNotifierGetEventHandle() failed: 0x%x.\n\n", ret);
+            fsEventNotifierClose(notifier);
+            return false;
+        }
+
+        return true;
+    }
+
+    static void Run(void) {
+        Result ret = 0;
+        s32 index = -1;
+
+        while (true) {
+            if (R_FAILED(ret = waitObjects(&index, g_waiters, g_waiter_count, UINT64_MAX))) {
+                std::printf("waitObjects() failed: 0x%x.\n\n", ret);
+                break;
+            }
+
+            // Index 0 is the exit event.
+            if (index == 0)
+                break;
+
+            if (g_waiter_events[index] != nullptr)
+                eventClear(g_waiter_events[index]);
+
+            Events::Post(g_waiter_masks[index]);
+        }
+    }
+
+    void Init(void) {
+        Result ret = 0;
+
+        ueventCreate(&g_exit_event, false);
+        Events::AddWaiter(waiterForUEvent(&g_exit_event), nullptr, 0);
+
+        if (R_FAILED(ret = STATS_CALL(psmBindStateChangeEvent, &g_psm_session, true, true, true)))
+            std::printf("psmBindStateChangeEvent() failed: 0x%x.\n\n", ret);
+        else {
+            g_psm_bound = true;
+            Events::AddWaiter(waiterForEvent(&g_psm_session.StateChangeEvent), &g_psm_session.StateChangeEvent, SwitchIdent::SnapshotEvent_PowerState);
+        }
+
+        if ((g_sd_open = Events::OpenFsNotifier(fsOpenSdCardDetectionEventNotifier, &g_sd_notifier, &g_sd_event, "fsOpenSdCardDetectionEventNotifier")))
+            Events::AddWaiter(waiterForEvent(&g_sd_event), &g_sd_event, SwitchIdent::SnapshotEvent_SdCard);
+
+        if ((g_gamecard_open = Events::OpenFsNotifier(fsOpenGameCardDetectionEventNotifier, &g_gamecard_notifier, &g_gamecard_event, "fsOpenGameCardDetectionEventNotifier")))
+            Events::AddWaiter(waiterForEvent(&g_gamecard_event), &g_gamecard_event, SwitchIdent::SnapshotEvent_GameCard);
+
+        // libnx does not expose nifm's network-change event, so SnapshotEvent_Network is only ever posted by
+        // other sources; the network fields keep their slow poll.
+        g_thread = std::thread(Events::Run);
+    }
+
+    void Exit(void) {
+        if (g_thread.joinable()) {
+            ueventSignal(&g_exit_event);
+            g_thread.join();
+        }
+
+        if (g_gamecard_open) {
+            eventClose(&g_gamecard_event);
+            fsEventNotifierClose(&g_gamecard_notifier);
+            g_gamecard_open = false;
+        }
+
+        if (g_sd_open) {
+            eventClose(&g_sd_event);
+            fsEventNotifierClose(&g_sd_notifier);
+            g_sd_open = false;
+        }
+
+        if (g_psm_bound) {
+            psmUnbindStateChangeEvent(&g_psm_session);
+            g_psm_bound = false;
+        }
+
+        g_waiter_count = 0;
+    }
+
+    void Post(u32 events) {
+        SwitchIdent::InvalidateSnapshot(events);
+        Sampler::Wake();
+    }
+}
@@ -0,0 +1,62 @@
+#include "governor.hpp"
+#include "sampler.hpp"
+#include "stats.hpp"
+
+namespace Governor {
+    static const u64 g_idle_timeout_ns = 5000000000ULL; // Without input for this long, the loop goes idle.
+    static const u64 g_poll_intervals[State_Count] = {
+        16666667,   // State_Active: 60 Hz
+        250000000,  // State_Idle: 4 Hz
+        100000000   // State_Suspended: only checks for focus coming back
+    };
+
+    static State g_state = State_Active;
+    static u64 g_state_start = 0;
+    static u64 g_last_input = 0;
+
+    static void Enter(State state, u64 now) {
+        static Stats::Counter *counters[State_Count] = {
+            Stats::GetCounter("Governor::Active"),
+            Stats::GetCounter("Governor::Idle"),
+            Stats::GetCounter("Governor::Suspended")
+        };
+
+        Stats::Record(counters[g_state], now - g_state_start, 0);
+
+        if (state == State_Suspended)
+            Sampler::SetPaused(true);
+        else if (g_state == State_Suspended)
+            Sampler::SetPaused(false);
+
+        g_state = state;
+        g_state_start = now;
+    }
+
+    State Update(bool input) {
+        u64 now = Stats::GetTimeNs();
+        State state = State_Active;
+
+        if (g_state_start == 0)
+            g_state_start = g_last_input = now;
+
+        if (input)
+            g_last_input = now;
+
+        // Coming back into focus counts as activity.
+        if (appletGetFocusState() != AppletFocusState_InFocus)
+            state = State_Suspended;
+        else if (g_state == State_Suspended)
+            g_last_input = now;
+        else if ((now - g_last_input) >= g_idle_timeout_ns)
+            state = State_Idle;
+
+        if (state != g_state)
+            Governor::Enter(state, now);
+
+        return g_state;
+    }
+
+    u64 GetPollInterval(State state) {
+        return g_poll_intervals[state];
+    }
+}
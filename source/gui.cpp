@@ -1,90 +1,416 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdio>
-#include <SDL2/SDL_image.h>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 
+#include "assets.hpp"
 #include "gui.hpp"
 #include "SDL_FontCache.h"
-
-SDL_Texture *banner = nullptr, *drive = nullptr, *menu_icons[7] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+#include "stats.hpp"
 
 namespace GUI {
     static SDL_Window *g_window = nullptr;
     static SDL_Renderer *g_renderer = nullptr;
+    static SDL_threadID g_render_thread = 0; // The thread that called Init(); everything but Load() runs on it.
     static FC_Font *g_font = nullptr; 
+    static SDL_Texture *g_atlas = nullptr;
 
-    static void LoadImage(SDL_Texture **texture, const char *path) {
-        SDL_Surface *image = nullptr;
-        image = IMG_Load(path);
-        
-        if (!image)
+    // The loader thread reads the asset bundle and rasterises the font into surfaces; the render thread uploads each
+    // stage once its flag is set. Text is not drawn until the font is ready, nor sprites until the atlas is.
+    static std::thread g_loader;
+    static std::atomic<bool> g_assets_prepared(false), g_font_prepared(false);
+    static TTF_Font *g_ttf = nullptr;
+    static void *g_ttf_data = nullptr; // SDL_ttf reads the face from this buffer for as long as g_ttf is open.
+    static bool g_assets_uploaded = false, g_font_ready = false;
+    static const int g_font_size = 25; // Also passed to tools/bake_glyphs by `make glyphs`.
+    static const char g_saved_glyphs_path[] = "sdmc:/switch/SwitchIdent_glyphs.bin";
+    static u64 g_ttf_hash = 0;
+    static unsigned int g_loaded_glyphs = 0; // Glyphs in the font once loaded; more means there is something to save.
+
+    // Per-frame command buffer. Rects, glyphs, sprites and cached rows are recorded as quads and grouped into batches
+    // of one texture each (nullptr for solid colour), which Render() submits as one SDL_RenderGeometry call apiece.
+    // A quad joins the most recent batch with its texture unless a batch recorded after that one overlaps it.
+    struct Quad {
+        SDL_FRect dest;
+        SDL_FPoint uv0;
+        SDL_FPoint uv1;
+        SDL_Color colour;
+        int batch;
+        int previous; // Previous quad in the same batch, or -1.
+    };
+
+    struct Batch {
+        SDL_Texture *texture;
+        SDL_FRect bounds;
+        int quad_count;
+        int last_quad;
+    };
+
+    static const int g_max_quads = 4096;
+    static const int g_max_batches = 256;
+    static const int g_batch_lookback = 16; // Batches searched back for a texture match before starting a new one.
+    static Quad g_quads[g_max_quads];
+    static Batch g_batches[g_max_batches];
+    static int g_quad_count = 0;
+    static int g_batch_count = 0;
+    static SDL_Vertex g_vertices[g_max_quads * 4];
+    static int g_indices[g_max_quads * 6];
+
+    // Draw calls the frame would have issued one by one, and the calls actually submitted.
+    static u32 g_frame_draws = 0, g_frame_submits = 0;
+    static u32 g_last_draws = 0, g_last_submits = 0;
+
+    // Retained "title: value" rows, composed into one texture each and keyed by their strings, colours and size.
+    struct TextCacheEntry {
+        u64 hash;
+        int size;
+        u32 title_colour;
+        u32 text_colour;
+        char title[64];
+        char text[256];
+        SDL_Texture *texture;
+        int width;
+        int height;
+        u64 last_used;
+    };
+
+    static const int g_text_cache_max_entries = 96;
+    static const u32 g_text_cache_budget = 8 * 1024 * 1024; // Bytes of RGBA texture memory.
+    static TextCacheEntry g_text_cache[g_text_cache_max_entries];
+    static int g_text_cache_count = 0;
+    static u32 g_text_cache_bytes = 0;
+    static u64 g_text_cache_clock = 0;
+    static SDL_BlendMode g_premultiplied_blend = SDL_BLENDMODE_BLEND;
+
+    // Measured strings, so row titles re-measured every frame don't walk their glyphs again. Direct-mapped by hash:
+    // a string replaces whatever shared its slot. Unsynchronised, so only GetTextDimensions() on the render thread
+    // may touch it.
+    struct MeasureCacheEntry {
+        u64 hash;
+        int size;
+        char text[64]; // Empty when the slot is unused; longer strings are measured every time.
+        u32 width;
+        u32 height;
+    };
+
+    static const int g_measure_cache_entries = 256; // Power of two.
+    static MeasureCacheEntry g_measure_cache[g_measure_cache_entries];
+
+    static void LoadTexture(SDL_Texture **texture, const char *name) {
+        const Assets::Image *image = Assets::Find(name);
+        if (image == nullptr)
             return;
-            
-        SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA8888, 0);
-        *texture = SDL_CreateTextureFromSurface(g_renderer, image);
-        SDL_FreeSurface(image);
+
+        *texture = SDL_CreateTexture(g_renderer, image->format, SDL_TEXTUREACCESS_STATIC, image->width, image->height);
+        if (*texture == nullptr)
+            return;
+
+        SDL_UpdateTexture(*texture, nullptr, image->pixels, image->pitch);
+        SDL_SetTextureBlendMode(*texture, SDL_BLENDMODE_BLEND);
+    }
+
+    static bool Overlaps(const SDL_FRect *a, const SDL_FRect *b) {
+        return (a->x < b->x + b->w) && (b->x < a->x + a->w) && (a->y < b->y + b->h) && (b->y < a->y + a->h);
+    }
+
+    static bool BatchOverlaps(const Batch *batch, const SDL_FRect *dest) {
+        if (!GUI::Overlaps(&batch->bounds, dest))
+            return false;
+
+        for (int i = batch->last_quad; i != -1; i = g_quads[i].previous) {
+            if (GUI::Overlaps(&g_quads[i].dest, dest))
+                return true;
+        }
+
+        return false;
+    }
+
+    static void Flush(void) {
+        if (g_quad_count == 0)
+            return;
+
+        // Lay every batch's quads out contiguously, keeping their recorded order within the batch.
+        int first[g_max_batches], written[g_max_batches];
+        for (int i = 0, offset = 0; i < g_batch_count; i++) {
+            first[i] = offset;
+            written[i] = 0;
+            offset += g_batches[i].quad_count;
+        }
+
+        for (int i = 0; i < g_quad_count; i++) {
+            const Quad *quad = &g_quads[i];
+            SDL_Vertex *vertices = &g_vertices[(first[quad->batch] + written[quad->batch]++) * 4];
+            const float x0 = quad->dest.x, y0 = quad->dest.y, x1 = quad->dest.x + quad->dest.w, y1 = quad->dest.y + quad->dest.h;
+
+            vertices[0] = { { x0, y0 }, quad->colour, { quad->uv0.x, quad->uv0.y } };
+            vertices[1] = { { x1, y0 }, quad->colour, { quad->uv1.x, quad->uv0.y } };
+            vertices[2] = { { x1, y1 }, quad->colour, { quad->uv1.x, quad->uv1.y } };
+            vertices[3] = { { x0, y1 }, quad->colour, { quad->uv0.x, quad->uv1.y } };
+        }
+
+        for (int i = 0; i < g_batch_count; i++) {
+            const Batch *batch = &g_batches[i];
+
+            // Colour travels in the vertices; the glyph caches still carry whatever modulation FC set last.
+            if (batch->texture != nullptr) {
+                SDL_SetTextureColorMod(batch->texture, 255, 255, 255);
+                SDL_SetTextureAlphaMod(batch->texture, 255);
+            }
+
+            SDL_RenderGeometry(g_renderer, batch->texture, &g_vertices[first[i] * 4], batch->quad_count * 4, g_indices, batch->quad_count * 6);
+            g_frame_submits++;
+        }
+
+        g_quad_count = 0;
+        g_batch_count = 0;
+    }
+
+    static void AddQuad(SDL_Texture *texture, const SDL_FRect *dest, SDL_FPoint uv0, SDL_FPoint uv1, SDL_Color colour) {
+        if ((g_quad_count == g_max_quads) || (g_batch_count == g_max_batches))
+            GUI::Flush();
+
+        int batch = -1;
+        for (int i = g_batch_count - 1; (i >= 0) && (i >= g_batch_count - g_batch_lookback); i--) {
+            if (g_batches[i].texture == texture) {
+                batch = i;
+                break;
+            }
+
+            if (GUI::BatchOverlaps(&g_batches[i], dest))
+                break;
+        }
+
+        if (batch == -1) {
+            batch = g_batch_count++;
+            g_batches[batch].texture = texture;
+            g_batches[batch].bounds = *dest;
+            g_batches[batch].quad_count = 0;
+            g_batches[batch].last_quad = -1;
+        }
+        else {
+            SDL_FRect *bounds = &g_batches[batch].bounds;
+            float x1 = std::max(bounds->x + bounds->w, dest->x + dest->w), y1 = std::max(bounds->y + bounds->h, dest->y + dest->h);
+            bounds->x = std::min(bounds->x, dest->x);
+            bounds->y = std::min(bounds->y, dest->y);
+            bounds->w = x1 - bounds->x;
+            bounds->h = y1 - bounds->y;
+        }
+
+        Quad *quad = &g_quads[g_quad_count];
+        quad->dest = *dest;
+        quad->uv0 = uv0;
+        quad->uv1 = uv1;
+        quad->colour = colour;
+        quad->batch = batch;
+        quad->previous = g_batches[batch].last_quad;
+        g_batches[batch].last_quad = g_quad_count++;
+        g_batches[batch].quad_count++;
+        g_frame_draws++;
+    }
+
+    // SDL_FontCache hands every glyph to this instead of SDL_RenderCopyEx. Glyphs drawn into a render target (cached
+    // rows being composed) go straight through; the rest are recorded in the frame's command buffer.
+    static FC_Rect RecordGlyph(FC_Image *src, FC_Rect *srcrect, FC_Target *dest, float x, float y, float xscale, float yscale) {
+        if (SDL_GetRenderTarget(dest) != nullptr)
+            return FC_DefaultRenderCallback(src, srcrect, dest, x, y, xscale, yscale);
+
+        int width = 0, height = 0;
+        SDL_Color colour;
+        SDL_QueryTexture(src, nullptr, nullptr, &width, &height);
+        SDL_GetTextureColorMod(src, &colour.r, &colour.g, &colour.b);
+        SDL_GetTextureAlphaMod(src, &colour.a);
+
+        SDL_FRect rect = { std::floor(x), std::floor(y), srcrect->w * xscale, srcrect->h * yscale };
+        const SDL_FPoint uv0 = { static_cast<float>(srcrect->x) / width, static_cast<float>(srcrect->y) / height };
+        const SDL_FPoint uv1 = { static_cast<float>(srcrect->x + srcrect->w) / width, static_cast<float>(srcrect->y + srcrect->h) / height };
+        GUI::AddQuad(src, &rect, uv0, uv1, colour);
+        return FC_MakeRect(x, y, rect.w, rect.h);
+    }
+
+    static bool PrepareFontFromCache(const char *path, SDL_Color colour) {
+        SDL_RWops *file = SDL_RWFromFile(path, "rb");
+        if (file == nullptr)
+            return false;
+
+        bool prepared = FC_PrepareFontFromCache(g_font, file, g_ttf, g_ttf_hash, g_font_size, colour);
+        SDL_RWclose(file);
+        return prepared;
+    }
+
+    // Keeps the glyphs drawn this run for the next, if any were rasterised since loading.
+    static void SaveGlyphs(void) {
+        static Stats::Counter *counter = Stats::GetCounter("GUI::SaveGlyphs");
+        if (!g_font_ready || (g_ttf == nullptr) || (FC_GetNumCodepoints(g_font) == g_loaded_glyphs))
+            return;
+
+        u64 start = Stats::GetTimeNs();
+        SDL_RWops *file = SDL_RWFromFile(g_saved_glyphs_path, "wb");
+        if (file == nullptr)
+            return;
+
+        bool saved = FC_SaveGlyphCache(g_font, file, g_ttf_hash, g_font_size);
+        SDL_RWclose(file);
+
+        // A partial file would only be rejected next time; don't leave one behind.
+        if (!saved)
+            std::remove(g_saved_glyphs_path);
+
+        Stats::Record(counter, Stats::GetTimeNs() - start, saved? 0 : -1);
+    }
+
+    static void Load(void) {
+        // Banner, drive and menu icons, packed and pre-decoded by tools/pack_atlas.py.
+        static Stats::Counter *assets_counter = Stats::GetCounter("GUI::LoadAssets");
+        u64 start = Stats::GetTimeNs();
+        Assets::Load("romfs:/assets.bin");
+        Stats::Record(assets_counter, Stats::GetTimeNs() - start, 0);
+        g_assets_prepared.store(true, std::memory_order_release);
+
+        // Timed separately by where the glyphs came from, so warm and cold starts can be told apart in the stats dump.
+        static Stats::Counter *font_counters[] = {
+            Stats::GetCounter("GUI::LoadFontSaved"),
+            Stats::GetCounter("GUI::LoadFontBaked"),
+            Stats::GetCounter("GUI::LoadFontTTF")
+        };
+
+        start = Stats::GetTimeNs();
+        size_t ttf_size = 0;
+        int source = 2;
+        g_ttf_data = Assets::ReadFile("romfs:/Ubuntu-Regular.ttf", &ttf_size);
+        if (g_ttf_data != nullptr)
+            g_ttf = TTF_OpenFontRW(SDL_RWFromConstMem(g_ttf_data, static_cast<int>(ttf_size)), 1, g_font_size);
+
+        if (g_ttf != nullptr) {
+            // Glyphs saved by the last run come first, as they include the dynamic text it drew; then the UI's own
+            // strings pre-rasterised by `make glyphs`. SDL_ttf renders everything here only if both are missing or
+            // were made from a different font or size.
+            SDL_Color colour = FC_MakeColor(0, 0, 0, 255);
+            g_ttf_hash = Assets::HashFont(g_ttf_data, ttf_size);
+            if (GUI::PrepareFontFromCache(g_saved_glyphs_path, colour))
+                source = 0;
+            else if (GUI::PrepareFontFromCache("romfs:/glyphs.bin", colour))
+                source = 1;
+            else if (!FC_PrepareFontFromTTF(g_font, g_ttf, colour)) {
+                TTF_CloseFont(g_ttf);
+                g_ttf = nullptr;
+            }
+
+            g_loaded_glyphs = FC_GetNumCodepoints(g_font);
+        }
+
+        Stats::Record(font_counters[source], Stats::GetTimeNs() - start, 0);
+        g_font_prepared.store(true, std::memory_order_release);
+
+        // Preparing the font formatted into this thread's own buffer, which FC_FreeFont() on the render thread can't free.
+        FC_FreeBuffer();
     }
 
     int Init(void) {
         if (SDL_Init(SDL_INIT_VIDEO) != 0)
             return -1;
+
+        g_render_thread = SDL_ThreadID();
             
         g_window = SDL_CreateWindow("SwitchIdent", 0, 0, 1280, 720, SDL_WINDOW_FULLSCREEN);
         if (g_window == nullptr)
             return -1;
             
         g_renderer = SDL_CreateRenderer(g_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        if (g_renderer == nullptr) // SDL's offscreen and dummy video drivers on the host build
+            g_renderer = SDL_CreateRenderer(g_window, -1, SDL_RENDERER_SOFTWARE);
         SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "2");
         
-        int flags = IMG_INIT_PNG;
-        if ((IMG_Init(flags) & flags) != flags)
+        for (int i = 0; i < g_max_quads; i++) {
+            int *indices = &g_indices[i * 6];
+            indices[0] = i * 4; indices[1] = i * 4 + 1; indices[2] = i * 4 + 2;
+            indices[3] = i * 4; indices[4] = i * 4 + 2; indices[5] = i * 4 + 3;
+        }
+
+        if (TTF_Init() != 0)
             return -1;
-            
-        GUI::LoadImage(&banner, "romfs:/banner.png");
-        GUI::LoadImage(&drive, "romfs:/drive.png");
-        GUI::LoadImage(&menu_icons[0], "romfs:/kernel.png");
-        GUI::LoadImage(&menu_icons[1], "romfs:/system.png");
-        GUI::LoadImage(&menu_icons[2], "romfs:/power.png");
-        GUI::LoadImage(&menu_icons[3], "romfs:/storage.png");
-        GUI::LoadImage(&menu_icons[4], "romfs:/joycon.png");
-        GUI::LoadImage(&menu_icons[5], "romfs:/misc.png");
-        GUI::LoadImage(&menu_icons[6], "romfs:/exit.png");
-        
+
+        FC_SetRenderCallback(GUI::RecordGlyph);
         g_font = FC_CreateFont();
-        FC_LoadFont(g_font, g_renderer, "romfs:/Ubuntu-Regular.ttf", 25, FC_MakeColor(0, 0, 0, 255), TTF_STYLE_NORMAL);
+        g_loader = std::thread(GUI::Load);
+
+        // Text drawn into a transparent target ends up with premultiplied colour, so cached rows are blended as such.
+        g_premultiplied_blend = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
         return 0;
     }
 
+    bool UpdateLoading(void) {
+        if (!g_assets_uploaded) {
+            if (!g_assets_prepared.load(std::memory_order_acquire))
+                return false;
+
+            GUI::LoadTexture(&g_atlas, "atlas");
+            Assets::Free();
+            g_assets_uploaded = true;
+            return true;
+        }
+
+        if (g_font_ready || !g_font_prepared.load(std::memory_order_acquire))
+            return false;
+
+        // One glyph cache level per call, so no single frame stalls on the whole upload.
+        if ((g_ttf != nullptr) && (FC_UploadPreparedGlyphCache(g_font, g_renderer) > 0))
+            return false;
+
+        g_loader.join();
+        g_font_ready = true;
+        return true;
+    }
+
+    bool IsLoaded(void) {
+        return g_assets_uploaded && g_font_ready;
+    }
+
     void Exit(void) {
+        if (g_loader.joinable())
+            g_loader.join();
+
+        GUI::SaveGlyphs();
+
+        for (int i = 0; i < g_text_cache_count; i++)
+            SDL_DestroyTexture(g_text_cache[i].texture);
+
+        g_text_cache_count = 0;
+        g_text_cache_bytes = 0;
         FC_FreeFont(g_font);
-        SDL_DestroyTexture(menu_icons[6]);
-        SDL_DestroyTexture(menu_icons[5]);
-        SDL_DestroyTexture(menu_icons[4]);
-        SDL_DestroyTexture(menu_icons[3]);
-        SDL_DestroyTexture(menu_icons[2]);
-        SDL_DestroyTexture(menu_icons[1]);
-        SDL_DestroyTexture(menu_icons[0]);
-        SDL_DestroyTexture(banner);
-        SDL_DestroyTexture(drive);
+        if (g_ttf != nullptr)
+            TTF_CloseFont(g_ttf);
+
+        std::free(g_ttf_data);
+        Assets::Free();
+        SDL_DestroyTexture(g_atlas);
         TTF_Quit();
-        IMG_Quit();
         SDL_DestroyRenderer(g_renderer);
         SDL_DestroyWindow(g_window);
         SDL_Quit();
     }
 
     void ClearScreen(SDL_Color colour) {
+        GUI::Flush();
         SDL_SetRenderDrawColor(g_renderer, colour.r, colour.g, colour.b, colour.a);
         SDL_RenderClear(g_renderer);
+        g_frame_draws++;
+        g_frame_submits++;
     }
     
     void DrawRect(int x, int y, int w, int h, SDL_Color colour) {
-        SDL_Rect rect;
-        rect.x = x; rect.y = y; rect.w = w; rect.h = h;
-        SDL_SetRenderDrawColor(g_renderer, colour.r, colour.g, colour.b, colour.a);
-        SDL_RenderFillRect(g_renderer, &rect);
+        const SDL_FRect rect = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(w), static_cast<float>(h) };
+        GUI::AddQuad(nullptr, &rect, { 0, 0 }, { 0, 0 }, colour);
     }
     
     void DrawText(int x, int y, int size, SDL_Color colour, const char *text) {
-        FC_DrawColor(g_font, g_renderer, x, y, colour, text);
+        if (!g_font_ready)
+            return;
+
+        FC_DrawColorUnformatted(g_font, g_renderer, x, y, colour, text);
     }
     
     void DrawTextf(int x, int y, int size, SDL_Color colour, const char* text, ...) {
@@ -96,21 +422,183 @@ namespace GUI {
         va_end(args);
     }
     
+    static u32 PackColour(SDL_Color colour) {
+        return (colour.r << 24) | (colour.g << 16) | (colour.b << 8) | colour.a;
+    }
+
+    static u64 HashText(u64 hash, const char *text) {
+        for (const unsigned char *c = reinterpret_cast<const unsigned char *>(text); *c != '\0'; c++)
+            hash = (hash ^ *c) * 0x100000001B3ULL;
+
+        return (hash ^ 0xFF) * 0x100000001B3ULL;
+    }
+
+    static void RemoveTextCacheEntry(int index) {
+        TextCacheEntry *entry = &g_text_cache[index];
+        SDL_DestroyTexture(entry->texture);
+        g_text_cache_bytes -= entry->width * entry->height * 4;
+        *entry = g_text_cache[--g_text_cache_count];
+    }
+
+    // Drops least recently drawn rows until `bytes` more fit in the budget and there is a free slot.
+    static void EvictText(u32 bytes) {
+        while ((g_text_cache_count > 0) && ((g_text_cache_count == g_text_cache_max_entries) || (g_text_cache_bytes + bytes > g_text_cache_budget))) {
+            int oldest = 0;
+
+            for (int i = 1; i < g_text_cache_count; i++) {
+                if (g_text_cache[i].last_used < g_text_cache[oldest].last_used)
+                    oldest = i;
+            }
+
+            GUI::RemoveTextCacheEntry(oldest);
+        }
+    }
+
+    static TextCacheEntry *ComposeItem(int size, SDL_Color title_colour, const char *title, int gap, SDL_Color text_colour, const char *text, u64 hash) {
+        if ((std::strlen(title) >= sizeof(g_text_cache[0].title)) || (std::strlen(text) >= sizeof(g_text_cache[0].text)))
+            return nullptr;
+
+        u32 title_width = 0, text_width = 0;
+        GUI::GetTextDimensions(size, title, &title_width, nullptr);
+        GUI::GetTextDimensions(size, text, &text_width, nullptr);
+        int width = title_width + gap + text_width;
+        int height = FC_GetLineHeight(g_font);
+        if ((width <= 0) || (height <= 0))
+            return nullptr;
+
+        GUI::EvictText(width * height * 4);
+
+        SDL_Texture *texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (texture == nullptr)
+            return nullptr;
+
+        SDL_Texture *target = SDL_GetRenderTarget(g_renderer);
+        if (SDL_SetRenderTarget(g_renderer, texture) != 0) {
+            SDL_DestroyTexture(texture);
+            return nullptr;
+        }
+
+        SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 0);
+        SDL_RenderClear(g_renderer);
+        FC_DrawColorUnformatted(g_font, g_renderer, 0, 0, title_colour, title);
+        FC_DrawColorUnformatted(g_font, g_renderer, title_width + gap, 0, text_colour, text);
+        SDL_SetRenderTarget(g_renderer, target);
+        SDL_SetTextureBlendMode(texture, g_premultiplied_blend);
+
+        TextCacheEntry *entry = &g_text_cache[g_text_cache_count++];
+        entry->hash = hash;
+        entry->size = size;
+        entry->title_colour = GUI::PackColour(title_colour);
+        entry->text_colour = GUI::PackColour(text_colour);
+        std::strcpy(entry->title, title);
+        std::strcpy(entry->text, text);
+        entry->texture = texture;
+        entry->width = width;
+        entry->height = height;
+        g_text_cache_bytes += width * height * 4;
+        return entry;
+    }
+
+    void DrawItem(int x, int y, int size, SDL_Color title_colour, const char *title, int gap, SDL_Color text_colour, const char *text) {
+        if (!g_font_ready)
+            return;
+
+        u32 packed_title_colour = GUI::PackColour(title_colour), packed_text_colour = GUI::PackColour(text_colour);
+        u64 hash = GUI::HashText(GUI::HashText(0xCBF29CE484222325ULL ^ size ^ (static_cast<u64>(packed_title_colour) << 8) ^
+            (static_cast<u64>(packed_text_colour) << 32) ^ gap, title), text);
+        TextCacheEntry *entry = nullptr;
+
+        for (int i = 0; i < g_text_cache_count; i++) {
+            TextCacheEntry *candidate = &g_text_cache[i];
+
+            if ((candidate->hash == hash) && (candidate->size == size) && (candidate->title_colour == packed_title_colour) &&
+                (candidate->text_colour == packed_text_colour) && (std::strcmp(candidate->title, title) == 0) && (std::strcmp(candidate->text, text) == 0)) {
+                entry = candidate;
+                break;
+            }
+        }
+
+        if (entry == nullptr)
+            entry = GUI::ComposeItem(size, title_colour, title, gap, text_colour, text, hash);
+
+        // Rows that cannot be cached (too long, or no render-target support) are drawn directly.
+        if (entry == nullptr) {
+            u32 title_width = 0;
+            GUI::GetTextDimensions(size, title, &title_width, nullptr);
+            GUI::DrawText(x, y, size, title_colour, title);
+            GUI::DrawText(x + title_width + gap, y, size, text_colour, text);
+            return;
+        }
+
+        entry->last_used = ++g_text_cache_clock;
+
+        const SDL_FRect position = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(entry->width), static_cast<float>(entry->height) };
+        const SDL_Color white = { 255, 255, 255, 255 };
+        GUI::AddQuad(entry->texture, &position, { 0, 0 }, { 1, 1 }, white);
+    }
+    
     void GetTextDimensions(int size, const char *text, u32 *width, u32 *height) {
+        u32 text_width = 0, text_height = 0;
+
+        SDL_assert(SDL_ThreadID() == g_render_thread);
+        if (g_font_ready) {
+            u64 hash = GUI::HashText(0xCBF29CE484222325ULL ^ size, text);
+            MeasureCacheEntry *entry = &g_measure_cache[hash & (g_measure_cache_entries - 1)];
+
+            if ((entry->hash == hash) && (entry->size == size) && (std::strcmp(entry->text, text) == 0)) {
+                text_width = entry->width;
+                text_height = entry->height;
+            }
+            else {
+                Uint8 complete = 0;
+                text_width = FC_GetWidthUnformattedComplete(g_font, text, &complete);
+                text_height = FC_GetHeightUnformatted(g_font, text);
+
+                // Glyphs are rasterised here as needed, but one that can't be added right now (no TTF source, or no
+                // room for another cache level) is measured as a space. That width isn't kept, so the string is
+                // measured again until the glyph is in.
+                if (complete && (std::strlen(text) < sizeof(entry->text))) {
+                    entry->hash = hash;
+                    entry->size = size;
+                    std::strcpy(entry->text, text);
+                    entry->width = text_width;
+                    entry->height = text_height;
+                }
+            }
+        }
+
         if (width != nullptr) 
-            *width = FC_GetWidth(g_font, text);
+            *width = text_width;
         if (height != nullptr) 
-            *height = FC_GetHeight(g_font, text);
+            *height = text_height;
     }
     
-    void DrawImage(SDL_Texture *texture, int x, int y) {
-        SDL_Rect position;
-        position.x = x; position.y = y;
-        SDL_QueryTexture(texture, nullptr, nullptr, &position.w, &position.h);
-        SDL_RenderCopy(g_renderer, texture, nullptr, &position);
+    void DrawSprite(Atlas::Sprite sprite, int x, int y) {
+        if (g_atlas == nullptr)
+            return;
+
+        const Atlas::SpriteRect *rect = &Atlas::Sprites[sprite];
+        const float u0 = static_cast<float>(rect->x) / Atlas::Width, v0 = static_cast<float>(rect->y) / Atlas::Height;
+        const float u1 = static_cast<float>(rect->x + rect->w) / Atlas::Width, v1 = static_cast<float>(rect->y + rect->h) / Atlas::Height;
+        const SDL_Color white = { 255, 255, 255, 255 };
+
+        const SDL_FRect dest = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(rect->w), static_cast<float>(rect->h) };
+        GUI::AddQuad(g_atlas, &dest, { u0, v0 }, { u1, v1 }, white);
     }
     
     void Render(void) {
+        GUI::Flush();
         SDL_RenderPresent(g_renderer);
+        g_last_draws = g_frame_draws;
+        g_last_submits = g_frame_submits;
+        g_frame_draws = 0;
+        g_frame_submits = 0;
+    }
+
+    void GetDrawCalls(u32 *recorded, u32 *submitted) {
+        if (recorded != nullptr)
+            *recorded = g_last_draws;
+        if (submitted != nullptr)
+            *submitted = g_last_submits;
     }
 }
@@ -35,17 +35,35 @@ namespace SwitchIdent {
         return info;
     }
 
-    HidPowerInfo GetJoyconPowerInfoL(HidNpadIdType id) {
-        HidPowerInfo info_left;
-        HidPowerInfo info_right;
-        hidGetNpadPowerInfoSplit(id, &info_left, &info_right);
-        return info_left;
-    }
-
-    HidPowerInfo GetJoyconPowerInfoR(HidNpadIdType id) {
-        HidPowerInfo info_left;
-        HidPowerInfo info_right;
-        hidGetNpadPowerInfoSplit(id, &info_left, &info_right);
-        return info_right;
+    // One pass over every npad; each connected controller costs a single power info read.
+    void GetJoyconPowerList(JoyconPowerList *list) {
+        const HidNpadIdType ids[] = {
+            HidNpadIdType_Handheld,
+            HidNpadIdType_No1, HidNpadIdType_No2, HidNpadIdType_No3, HidNpadIdType_No4,
+            HidNpadIdType_No5, HidNpadIdType_No6, HidNpadIdType_No7, HidNpadIdType_No8
+        };
+        
+        const u32 left_styles = HidNpadStyleTag_NpadHandheld | HidNpadStyleTag_NpadJoyDual | HidNpadStyleTag_NpadJoyLeft;
+        const u32 right_styles = HidNpadStyleTag_NpadHandheld | HidNpadStyleTag_NpadJoyDual | HidNpadStyleTag_NpadJoyRight;
+        
+        list->count = 0;
+        
+        for (unsigned int i = 0; i < (sizeof(ids) / sizeof(ids[0])); i++) {
+            u32 style_set = hidGetNpadStyleSet(ids[i]);
+            if (style_set == 0)
+                continue;
+                
+            JoyconPower *pad = &list->pads[list->count++];
+            pad->id = ids[i];
+            pad->style_set = style_set;
+            pad->has_left = (style_set & left_styles) != 0;
+            pad->has_right = (style_set & right_styles) != 0;
+            pad->is_split = pad->has_left || pad->has_right;
+            
+            if (pad->is_split)
+                hidGetNpadPowerInfoSplit(ids[i], &pad->left, &pad->right);
+            else
+                hidGetNpadPowerInfoSingle(ids[i], &pad->single);
+        }
     }
 }
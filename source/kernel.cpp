@@ -1,6 +1,7 @@
 #include <cstdio>
 
 #include "common.hpp"
+#include "stats.hpp"
 
 namespace SwitchIdent {
     const char *GetDramDesc(void) {
@@ -41,7 +42,7 @@ namespace SwitchIdent {
             "Unknown"
         };
         
-        if (R_FAILED(ret = splGetConfig(SplConfigItem_DramId, &id)))
+        if (R_FAILED(ret = STATS_CALL(splGetConfig, SplConfigItem_DramId, &id)))
             std::printf("splGetConfig(SplConfigItem_DramId) failed: 0x%x.\n\n", ret);
             
         if (id >= 30)
@@ -54,7 +55,7 @@ namespace SwitchIdent {
         Result ret = 0;
         SetSysFirmwareVersion version;
         
-        if (R_FAILED(ret = setsysGetFirmwareVersion(&version)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetFirmwareVersion, &version)))
             std::printf("setsysGetFirmwareVersion() failed: 0x%x.\n\n", ret);
 
         return version;
@@ -74,7 +75,7 @@ namespace SwitchIdent {
             "Unknown"
         };
         
-        if (R_FAILED(ret = splGetConfig(SplConfigItem_HardwareType, &hardware_type)))
+        if (R_FAILED(ret = STATS_CALL(splGetConfig, SplConfigItem_HardwareType, &hardware_type)))
             std::printf("splGetConfig(SplConfigItem_HardwareType) failed: 0x%x.\n\n", ret);
             
         if (hardware_type >= 6)
@@ -88,7 +89,7 @@ namespace SwitchIdent {
         u64 is_kiosk_mode = 0;
         Result ret = 0;
         
-        if (R_FAILED(ret = splGetConfig(SplConfigItem_IsKiosk , &is_kiosk_mode)))
+        if (R_FAILED(ret = STATS_CALL(splGetConfig, SplConfigItem_IsKiosk , &is_kiosk_mode)))
             std::printf("splGetConfig(SplConfigItem_IsKiosk) failed: 0x%x.\n\n", ret);
         
         return is_kiosk_mode? true : false;
@@ -104,7 +105,7 @@ namespace SwitchIdent {
             "Unknown"
         };
         
-        if (R_FAILED(ret = splGetConfig(SplConfigItem_IsRetail, &is_retail_mode))) {
+        if (R_FAILED(ret = STATS_CALL(splGetConfig, SplConfigItem_IsRetail, &is_retail_mode))) {
             std::printf("splGetConfig(SplConfigItem_IsRetail) failed: 0x%x.\n\n", ret);
             return unit[2];
         }
@@ -116,7 +117,7 @@ namespace SwitchIdent {
         Result ret = 0;
         u64 safemode = 0;
         
-        if (R_FAILED(ret = splGetConfig(SplConfigItem_IsRecoveryBoot, &safemode)))
+        if (R_FAILED(ret = STATS_CALL(splGetConfig, SplConfigItem_IsRecoveryBoot, &safemode)))
             std::printf("splGetConfig(SplConfigItem_IsRecoveryBoot) failed: 0x%x.\n\n", ret);
             
         if (safemode)
@@ -129,7 +130,7 @@ namespace SwitchIdent {
         Result ret = 0;
         u64 id = 0;
         
-        if (R_FAILED(ret = splGetConfig(SplConfigItem_DeviceId, &id)))
+        if (R_FAILED(ret = STATS_CALL(splGetConfig, SplConfigItem_DeviceId, &id)))
             std::printf("splGetConfig(SplConfigItem_DeviceId) failed: 0x%x.\n\n", ret);
             
         return id;
@@ -139,7 +140,7 @@ namespace SwitchIdent {
         Result ret = 0;
         SetSysSerialNumber serial;
         
-        if (R_FAILED(ret = setsysGetSerialNumber(&serial)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetSerialNumber, &serial)))
             std::printf("setsysGetSerialNumber() failed: 0x%x.\n\n", ret);
             
         return serial;
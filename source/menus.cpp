@@ -1,20 +1,30 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
-#include <unistd.h>
+#include <cstring>
+#include <thread>
 
 #include "common.hpp"
+#include "governor.hpp"
 #include "gui.hpp"
 #include "menus.hpp"
+#include "sampler.hpp"
+#include "services.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
 #include "SDL_FontCache.h"
 
 namespace Menus {
     // Globals
     static u32 g_item_height = 0;
-    static bool g_is_sd_inserted = false, g_is_gamecard_inserted = false;
     static HidsysUniquePadId g_unique_pad_ids[2] = {0};
     static PadState g_pad;
     static const int g_item_dist = 67;
     static const int g_start_x = 450;
     static const int g_start_y = 250;
+    static const char g_stats_path[] = "sdmc:/switch/SwitchIdent_stats.csv";
+    static const u64 g_diagnostics_interval_ns = 500000000; // The diagnostics page redraws its live counters at 2 Hz.
+    static const u64 g_vsync_ns = 16666667; // The renderer presents on vsync at 60 Hz.
 
     // Colours
     static const SDL_Color bg_colour = FC_MakeColor(62, 62, 62, 255);
@@ -31,210 +41,305 @@ namespace Menus {
         STATE_STORAGE_INFO,
         STATE_JOYCON_INFO,
         STATE_MISC_INFO,
+        STATE_DIAGNOSTICS_INFO,
         STATE_EXIT,
         MAX_ITEMS
     };
     
     static void DrawItem(int x, int y, const char *title, const char *text) {
-        u32 title_width = 0;
-        GUI::GetTextDimensions(25, title, &title_width, nullptr);
-        GUI::DrawText(x, y, 25, title_colour, title);
-        GUI::DrawText(x + title_width + 20, y, 25, descr_colour, text);
+        GUI::DrawItem(x, y, 25, title_colour, title, 20, descr_colour, text);
     }
 
     static void DrawItemf(int x, int y, const char *title, const char *text, ...) {
-        u32 title_width = 0;
-        GUI::GetTextDimensions(25, title, &title_width, nullptr);
-        GUI::DrawText(x, y, 25, title_colour, title);
-        
         char buffer[256];
         va_list args;
         va_start(args, text);
         std::vsnprintf(buffer, 256, text, args);
-        GUI::DrawText(x + title_width + 20, y, 25, descr_colour, buffer);
+        GUI::DrawItem(x, y, 25, title_colour, title, 20, descr_colour, buffer);
         va_end(args);
     }
 
-    void KernelInfo(void) {
-        SetSysFirmwareVersion ver = SwitchIdent::GetFirmwareVersion();
-        Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 50, "固件版本:", 
-            "%u.%u.%u-%u%u", ver.major, ver.minor, ver.micro, ver.revision_major, ver.revision_minor);
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 100, "硬件:", SwitchIdent::GetHardwareType());
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 150, "Unit:", SwitchIdent::GetUnit());
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 200, "序列号:", SwitchIdent::GetSerialNumber().number);
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 250, "内存ID:", SwitchIdent::GetDramDesc());
-        Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 300, "驱动ID:", "%llu", SwitchIdent::GetDeviceID());
+    // A row of a data page: its label, how its value is formatted from the snapshot, and how often the value can
+    // change. Rows of RefreshClass_Static are formatted once and then drawn from the stored string.
+    struct RowDescriptor {
+        const char *title;
+        void (*format)(const SwitchIdent::SystemSnapshot *s, char *out, size_t size);
+        SwitchIdent::RefreshClass refresh_class;
+    };
+
+    struct PageDescriptor {
+        int page;
+        const RowDescriptor *rows;
+        int count;
+    };
+
+    static const char *OnOff(bool enabled) {
+        return enabled? "开启" : "关闭";
     }
 
-    void SystemInfo(void) {
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 50, "地区:",  SwitchIdent::GetRegion());
-        Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 100, "CPU频率:", "%lu MHz", SwitchIdent::GetClock(PcvModule_CpuBus));
-        Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 150, "GPU频率:", "%lu MHz", SwitchIdent::GetClock(PcvModule_GPU));
-        Menus::DrawItemf(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 200,
-            "EMC频率:", "%lu MHz", SwitchIdent::GetClock(PcvModule_EMC));
-        Menus::DrawItemf(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 250,
-            "无线网络:", "%s (RSSI: %d) (信号强度: %lu)",
-            SwitchIdent::GetWirelessLanEnableFlag() ? "开启" : "关闭",
-            SwitchIdent::GetWlanRSSI(),
-            SwitchIdent::GetWlanQuality(SwitchIdent::GetWlanRSSI()));
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 300, "蓝牙:", SwitchIdent::GetBluetoothEnableFlag()? "开启" : "关闭");
-        Menus::DrawItem(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 350,
-            "NFC:", SwitchIdent::GetNfcEnableFlag() ? "开启" : "关闭");
+    static constexpr RowDescriptor g_kernel_rows[] = {
+        { "固件版本:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) {
+            const SetSysFirmwareVersion *ver = &s->kernel.firmware_version;
+            std::snprintf(out, size, "%u.%u.%u-%u%u", ver->major, ver->minor, ver->micro, ver->revision_major, ver->revision_minor);
+        }, SwitchIdent::RefreshClass_Static },
+        { "硬件:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->kernel.hardware_type); }, SwitchIdent::RefreshClass_Static },
+        { "Unit:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->kernel.unit); }, SwitchIdent::RefreshClass_Static },
+        { "序列号:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->kernel.serial_number.number); }, SwitchIdent::RefreshClass_Static },
+        { "内存ID:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->kernel.dram_desc); }, SwitchIdent::RefreshClass_Static },
+        { "驱动ID:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%llu", static_cast<unsigned long long>(s->kernel.device_id)); }, SwitchIdent::RefreshClass_Static },
+    };
+
+    static constexpr RowDescriptor g_system_rows[] = {
+        { "地区:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->system.region); }, SwitchIdent::RefreshClass_Static },
+        { "CPU频率:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%u MHz", s->system.cpu_clock); }, SwitchIdent::RefreshClass_Fast },
+        { "GPU频率:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%u MHz", s->system.gpu_clock); }, SwitchIdent::RefreshClass_Fast },
+        { "EMC频率:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%u MHz", s->system.emc_clock); }, SwitchIdent::RefreshClass_Fast },
+        { "无线网络:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) {
+            std::snprintf(out, size, "%s (RSSI: %d) (信号强度: %d)", Menus::OnOff(s->system.wlan_enabled), s->system.wlan_rssi, s->system.wlan_quality);
+        }, SwitchIdent::RefreshClass_Fast },
+        { "蓝牙:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", Menus::OnOff(s->system.bluetooth_enabled)); }, SwitchIdent::RefreshClass_Slow },
+        { "NFC:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", Menus::OnOff(s->system.nfc_enabled)); }, SwitchIdent::RefreshClass_Slow },
+    };
+
+    static constexpr RowDescriptor g_power_rows[] = {
+        { "电池百分比:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) {
+            std::snprintf(out, size, "%u %% (%s)", s->power.battery_percentage, s->power.is_charging? "充电中" : "未充电");
+        }, SwitchIdent::RefreshClass_Fast },
+        { "电池电压状态:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->power.voltage_state); }, SwitchIdent::RefreshClass_Event },
+        { "电池充电器类型:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->power.charger_type); }, SwitchIdent::RefreshClass_Event },
+        { "电池充电已启用:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->power.charging_enabled? "是" : "否"); }, SwitchIdent::RefreshClass_Event },
+        { "电池供电充足:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->power.enough_power_supplied? "是" : "否"); }, SwitchIdent::RefreshClass_Event },
+        { "电池批号:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->power.battery_lot.lot); }, SwitchIdent::RefreshClass_Static },
+    };
+
+    static constexpr RowDescriptor g_misc_rows[] = {
+        { "IP地址:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->misc.has_ip_address? s->misc.ip_address : ""); }, SwitchIdent::RefreshClass_Slow },
+        { "主机模式:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->misc.operation_mode); }, SwitchIdent::RefreshClass_Fast },
+        { "自动更新:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", Menus::OnOff(s->misc.auto_update_enabled)); }, SwitchIdent::RefreshClass_Slow },
+        { "控制台信息上传:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", Menus::OnOff(s->misc.console_info_upload_enabled)); }, SwitchIdent::RefreshClass_Slow },
+        { "SD卡状态:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->misc.sd_inserted? "已插入" : "未插入"); }, SwitchIdent::RefreshClass_Event },
+        { "游戏卡状态:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) { std::snprintf(out, size, "%s", s->misc.gamecard_inserted? "已插入" : "未插入"); }, SwitchIdent::RefreshClass_Event },
+        { "BT地址:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) {
+            const u8 *addr = s->misc.bd_addr.bd_addr;
+            std::snprintf(out, size, "%02X:%02X:%02X:%02X:%02X:%02X", addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
+        }, SwitchIdent::RefreshClass_Static },
+        { "WLAN地址:", [](const SwitchIdent::SystemSnapshot *s, char *out, size_t size) {
+            const u8 *addr = s->misc.mac_addr.addr;
+            std::snprintf(out, size, "%02X:%02X:%02X:%02X:%02X:%02X", addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
+        }, SwitchIdent::RefreshClass_Static },
+    };
+
+    static constexpr PageDescriptor g_pages[] = {
+        { STATE_KERNEL_INFO, g_kernel_rows, sizeof(g_kernel_rows) / sizeof(g_kernel_rows[0]) },
+        { STATE_SYSTEM_INFO, g_system_rows, sizeof(g_system_rows) / sizeof(g_system_rows[0]) },
+        { STATE_POWER_INFO, g_power_rows, sizeof(g_power_rows) / sizeof(g_power_rows[0]) },
+        { STATE_MISC_INFO, g_misc_rows, sizeof(g_misc_rows) / sizeof(g_misc_rows[0]) },
+    };
+
+    // Resolved position and last formatted value of one row; built by Layout(), walked by DrawPage().
+    struct DrawRecord {
+        int x;
+        int y;
+        const RowDescriptor *row;
+        bool formatted;
+        char value[128];
+    };
+
+    static const int g_max_rows = 8;
+    static DrawRecord g_records[MAX_ITEMS][g_max_rows];
+    static int g_record_counts[MAX_ITEMS] = { 0 };
+    static int g_row_y = 0; // Text y of the first row on every page.
+
+    // Positions only depend on the font's line height, so this runs once at startup (and again if the font changes).
+    static void Layout(void) {
+        g_row_y = g_start_y + ((g_item_dist - g_item_height) / 2) + 50;
+
+        for (const PageDescriptor &page : g_pages) {
+            for (int i = 0; (i < page.count) && (i < g_max_rows); i++) {
+                DrawRecord *record = &g_records[page.page][i];
+                record->x = g_start_x;
+                record->y = g_row_y + (i * 50);
+                record->row = &page.rows[i];
+                record->formatted = false;
+            }
+
+            g_record_counts[page.page] = (page.count < g_max_rows)? page.count : g_max_rows;
+        }
     }
 
-    void PowerInfo(void) {
-      Menus::DrawItemf(
-          g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 50,
-          "电池百分比:", "%lu %% (%s)", SwitchIdent::GetBatteryPercentage(),
-          SwitchIdent::IsCharging() ? "充电中" : "未充电");
-      Menus::DrawItem(g_start_x,
-                      g_start_y + ((g_item_dist - g_item_height) / 2) + 100,
-                      "电池电压状态:", SwitchIdent::GetVoltageState());
-      Menus::DrawItem(g_start_x,
-                      g_start_y + ((g_item_dist - g_item_height) / 2) + 150,
-                      "电池充电器类型:", SwitchIdent::GetChargerType());
-      Menus::DrawItem(
-          g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 200,
-          "电池充电已启用:", SwitchIdent::IsChargingEnabled() ? "是" : "否");
-      Menus::DrawItem(
-          g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 250,
-          "电池供电充足:", SwitchIdent::IsEnoughPowerSupplied() ? "是" : "否");
-      Menus::DrawItem(g_start_x,
-                      g_start_y + ((g_item_dist - g_item_height) / 2) + 300,
-                      "电池批号:", SwitchIdent::GetBatteryLot().lot);
+    // Returns false for pages that are not described by rows.
+    static bool DrawPage(int page, const SwitchIdent::SystemSnapshot *snapshot) {
+        for (int i = 0; i < g_record_counts[page]; i++) {
+            DrawRecord *record = &g_records[page][i];
+
+            if (!record->formatted || (record->row->refresh_class != SwitchIdent::RefreshClass_Static)) {
+                record->row->format(snapshot, record->value, sizeof(record->value));
+                record->formatted = true;
+            }
+
+            GUI::DrawItem(record->x, record->y, 25, title_colour, record->row->title, 20, descr_colour, record->value);
+        }
+
+        return g_record_counts[page] != 0;
     }
 
-    void StorageInfo(void) {
-        u64 sd_used = SwitchIdent::GetUsedStorage(NcmStorageId_SdCard);
-        u64 sd_total = SwitchIdent::GetTotalStorage(NcmStorageId_SdCard);
-        
-        u64 nand_u_used = SwitchIdent::GetUsedStorage(NcmStorageId_BuiltInUser);
-        u64 nand_u_total = SwitchIdent::GetTotalStorage(NcmStorageId_BuiltInUser);
-        
-        u64 nand_s_used = SwitchIdent::GetUsedStorage(NcmStorageId_BuiltInSystem);
-        u64 nand_s_total = SwitchIdent::GetTotalStorage(NcmStorageId_BuiltInSystem);
-        
-        char sd_total_str[16], sd_free_str[16], sd_used_str[16];
-        SwitchIdent::GetSizeString(sd_total_str, sd_total);
-        SwitchIdent::GetSizeString(sd_free_str, SwitchIdent::GetFreeStorage(NcmStorageId_SdCard));
-        SwitchIdent::GetSizeString(sd_used_str, sd_used);
-        
-        char nand_u_total_str[16], nand_u_free_str[16], nand_u_used_str[16];
-        SwitchIdent::GetSizeString(nand_u_total_str, nand_u_total);
-        SwitchIdent::GetSizeString(nand_u_free_str, SwitchIdent::GetFreeStorage(NcmStorageId_BuiltInUser));
-        SwitchIdent::GetSizeString(nand_u_used_str, nand_u_used);
-        
-        char nand_s_total_str[16], nand_s_free_str[16], nand_s_used_str[16];
-        SwitchIdent::GetSizeString(nand_s_total_str, nand_s_total);
-        SwitchIdent::GetSizeString(nand_s_free_str, SwitchIdent::GetFreeStorage(NcmStorageId_BuiltInSystem));
-        SwitchIdent::GetSizeString(nand_s_used_str, nand_s_used);
-        
+    static void StorageBlock(int y, const char *name, const SwitchIdent::StorageUsage *usage) {
+        char total_str[16], free_str[16], used_str[16];
+        SwitchIdent::GetSizeString(total_str, usage->total);
+        SwitchIdent::GetSizeString(free_str, usage->free);
+        SwitchIdent::GetSizeString(used_str, usage->used);
+
+        GUI::DrawRect(450, y + 188, 128, 25, descr_colour);
+        GUI::DrawRect(452, y + 190, 124, 21, bg_colour);
+        if (usage->total > 0)
+            GUI::DrawRect(452, y + 190, (((double)usage->used / (double)usage->total) * 124.0), 21, selector_colour);
+
+        GUI::DrawText(600, y + ((g_item_dist - g_item_height) / 2) + 50, 25, descr_colour, name);
+        Menus::DrawItem(600, y + ((g_item_dist - g_item_height) / 2) + 88, "总存储容量:", total_str);
+        Menus::DrawItem(600, y + ((g_item_dist - g_item_height) / 2) + 126, "空闲存储容量:", free_str);
+        Menus::DrawItem(600, y + ((g_item_dist - g_item_height) / 2) + 164, "已使用存储容量:", used_str);
+    }
+
+    void StorageInfo(const SwitchIdent::StorageStats *data) {
         GUI::DrawRect(400, 50, 880, 670, bg_colour);
-        
-        GUI::DrawImage(drive, 450, 88);
-        GUI::DrawRect(450, 226, 128, 25, descr_colour);
-        GUI::DrawRect(452, 228, 124, 21, bg_colour);
-        GUI::DrawRect(452, 228, (((double)sd_used / (double)sd_total) * 124.0), 21, selector_colour);
-        
-        GUI::DrawImage(drive, 450, 296);
-        GUI::DrawRect(450, 434, 128, 25, descr_colour);
-        GUI::DrawRect(452, 436, 124, 21, bg_colour);
-        GUI::DrawRect(452, 436, (((double)nand_u_used / (double)nand_u_total) * 124.0), 21, selector_colour);
-        
-        GUI::DrawImage(drive, 450, 504);
-        GUI::DrawRect(450, 642, 128, 25, descr_colour);
-        GUI::DrawRect(452, 644, 124, 21, bg_colour);
-        GUI::DrawRect(452, 644, (((double)nand_s_used / (double)nand_s_total) * 124.0), 21, selector_colour);
-        
-        GUI::DrawText(600, 38 + ((g_item_dist - g_item_height) / 2) + 50, 25, descr_colour, "SD");
-        Menus::DrawItem(600, 38 + ((g_item_dist - g_item_height) / 2) + 88,
-                        "总存储容量:", sd_total_str);
-        Menus::DrawItem(600, 38 + ((g_item_dist - g_item_height) / 2) + 126,
-                        "空闲存储容量:", sd_free_str);
-        Menus::DrawItem(600, 38 + ((g_item_dist - g_item_height) / 2) + 164, "已使用存储容量:", sd_used_str);
-        
-        GUI::DrawText(600, 246 + ((g_item_dist - g_item_height) / 2) + 50, 25, descr_colour, "NAND User");
-        Menus::DrawItem(600, 246 + ((g_item_dist - g_item_height) / 2) + 88,
-                        "总存储容量:", nand_u_total_str);
-        Menus::DrawItem(600, 246 + ((g_item_dist - g_item_height) / 2) + 126,
-                        "空闲存储容量:", nand_u_free_str);
-        Menus::DrawItem(600, 246 + ((g_item_dist - g_item_height) / 2) + 164,
-                        "已使用存储容量:", nand_u_used_str);
-
-        GUI::DrawText(600, 454 + ((g_item_dist - g_item_height) / 2) + 50, 25, descr_colour, "NAND System");
-        Menus::DrawItem(600, 454 + ((g_item_dist - g_item_height) / 2) + 88,
-                        "总存储容量:", nand_s_total_str);
-        Menus::DrawItem(600, 454 + ((g_item_dist - g_item_height) / 2) + 126,
-                        "空闲存储容量:", nand_s_free_str);
-        Menus::DrawItem(600, 454 + ((g_item_dist - g_item_height) / 2) + 164,
-                        "已使用存储容量:", nand_s_used_str);
+
+        // The three drive icons go out as one sprite batch.
+        GUI::DrawSprite(Atlas::Sprite_Drive, 450, 38 + 50);
+        GUI::DrawSprite(Atlas::Sprite_Drive, 450, 246 + 50);
+        GUI::DrawSprite(Atlas::Sprite_Drive, 450, 454 + 50);
+
+        Menus::StorageBlock(38, "SD", &data->slots[SwitchIdent::StorageSlot_SdCard]);
+        Menus::StorageBlock(246, "NAND User", &data->slots[SwitchIdent::StorageSlot_BuiltInUser]);
+        Menus::StorageBlock(454, "NAND System", &data->slots[SwitchIdent::StorageSlot_BuiltInSystem]);
     }
 
-    void JoyconInfo(void) {
+    void JoyconInfo(const SwitchIdent::JoyconPowerList *data) {
         // TODO: account for HidNpadIdType_Other;
-        // Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 50, "JC fw:", "%llu", SwitchIdent::GetJoyconFirmwareVersion(g_unique_pad_ids[0]));
-
-        HidPowerInfo info_left = SwitchIdent::GetJoyconPowerInfoL(padIsHandheld(&g_pad) ? HidNpadIdType_Handheld : HidNpadIdType_No1);
-        HidPowerInfo info_right = SwitchIdent::GetJoyconPowerInfoR(padIsHandheld(&g_pad) ? HidNpadIdType_Handheld : HidNpadIdType_No1);
-
-        Menus::DrawItemf(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 50,
-            "左 Joycon 电池:", "%lu %% (%s)", (info_left.battery_level * 25),
-            info_left.is_charging ? "充电中" : "未充电");
-        Menus::DrawItemf(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 100,
-            "右 Joycon 电池:", "%lu %% (%s)", (info_right.battery_level * 25),
-            info_right.is_charging ? "充电中" : "未充电");
+        // Menus::DrawItemf(g_start_x, g_row_y, "JC fw:", "%llu", SwitchIdent::GetJoyconFirmwareVersion(g_unique_pad_ids[0]));
+
+        if (data->count == 0) {
+            Menus::DrawItem(g_start_x, g_row_y, "手柄:", "未连接");
+            return;
+        }
+
+        for (int i = 0; i < data->count; i++) {
+            const SwitchIdent::JoyconPower *pad = &data->pads[i];
+            int y = g_row_y + (i * 45);
+
+            char title[32];
+            if (pad->id == HidNpadIdType_Handheld)
+                std::snprintf(title, sizeof(title), "掌机:");
+            else
+                std::snprintf(title, sizeof(title), "玩家 %d:", pad->id - HidNpadIdType_No1 + 1);
+
+            if (!pad->is_split)
+                Menus::DrawItemf(g_start_x, y, title, "%u %% (%s)", (pad->single.battery_level * 25), pad->single.is_charging? "充电中" : "未充电");
+            else if (pad->has_left && pad->has_right)
+                Menus::DrawItemf(g_start_x, y, title, "左 %u %% (%s)  右 %u %% (%s)",
+                    (pad->left.battery_level * 25), pad->left.is_charging? "充电中" : "未充电",
+                    (pad->right.battery_level * 25), pad->right.is_charging? "充电中" : "未充电");
+            else if (pad->has_left)
+                Menus::DrawItemf(g_start_x, y, title, "左 %u %% (%s)", (pad->left.battery_level * 25), pad->left.is_charging? "充电中" : "未充电");
+            else
+                Menus::DrawItemf(g_start_x, y, title, "右 %u %% (%s)", (pad->right.battery_level * 25), pad->right.is_charging? "充电中" : "未充电");
+        }
     }
 
-    void MiscInfo(void) {
-        char hostname[128];
-        Result ret = gethostname(hostname, sizeof(hostname));
-
-        SetCalBdAddress bd_addr = SwitchIdent::GetBluetoothBdAddress();
-        SetCalMacAddress mac_addr = SwitchIdent::GetWirelessLanMacAddress();
-
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 50, "IP地址:",  R_SUCCEEDED(ret)? hostname : nullptr);
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 100, "主机模式:", SwitchIdent::GetOperationMode());
-        Menus::DrawItem(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 150,
-            "自动更新:",
-            SwitchIdent::GetAutoUpdateEnableFlag() ? "开启" : "关闭");
-        Menus::DrawItem(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 200,
-            "控制台信息上传:",
-            SwitchIdent::GetConsoleInformationUploadFlag() ? "开启" : "关闭");
-        Menus::DrawItem(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 250, "SD卡状态:", g_is_sd_inserted? "已插入" : "未插入");
-        Menus::DrawItem(
-            g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 300,
-            "游戏卡状态:", g_is_gamecard_inserted ? "已插入" : "未插入");
-        Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 350, "BT地址:",
-            "%02X:%02X:%02X:%02X:%02X:%02X", bd_addr.bd_addr[0], bd_addr.bd_addr[1], bd_addr.bd_addr[2], bd_addr.bd_addr[3], bd_addr.bd_addr[4], bd_addr.bd_addr[5]);
-        Menus::DrawItemf(g_start_x, g_start_y + ((g_item_dist - g_item_height) / 2) + 400, "WLAN地址:", 
-            "%02X:%02X:%02X:%02X:%02X:%02X", mac_addr.addr[0], mac_addr.addr[1], mac_addr.addr[2], mac_addr.addr[3], mac_addr.addr[4], mac_addr.addr[5]);
+    // Counters listed per page of the diagnostics table, worst p99 first; left/right pages through the rest.
+    static const int g_diagnostics_rows = 12;
+
+    void DiagnosticsInfo(Result dump_result, bool dumped, int *page) {
+        int y = 240;
+        GUI::DrawTextf(g_start_x, y - 90, 25, descr_colour, "首帧 / 加载完成: %llu / %llu ms",
+            static_cast<unsigned long long>(Services::GetTimeToFirstFrame() / 1000000),
+            static_cast<unsigned long long>(Services::GetTimeToFullyLoaded() / 1000000));
+        GUI::DrawTextf(g_start_x, y - 30, 25, descr_colour, "渲染 / 跳过: %llu / %llu 帧",
+            static_cast<unsigned long long>(Stats::GetCounter("Menus::Render")->count.load()),
+            static_cast<unsigned long long>(Stats::GetCounter("Menus::Skip")->count.load()));
+        u32 recorded = 0, submitted = 0;
+        GUI::GetDrawCalls(&recorded, &submitted);
+        GUI::DrawTextf(g_start_x, y - 60, 25, descr_colour, "绘制调用 (记录 / 提交): %u / %u", recorded, submitted);
+        GUI::DrawText(g_start_x, y, 25, descr_colour, "调用 / 次数 / 错误 / 结果 / p50 / p99 / max (us)");
+
+        const Stats::Counter *counters[Stats::MaxCounters];
+        u64 p99[Stats::MaxCounters];
+        int count = std::min(Stats::GetCounterCount(), Stats::MaxCounters);
+        for (int i = 0; i < count; i++) {
+            counters[i] = Stats::GetCounterAt(i);
+            p99[i] = Stats::GetPercentile(counters[i], 99);
+        }
+
+        // Sorted on the p99s read once above, so a counter recording mid-sort cannot upset the order.
+        for (int i = 1; i < count; i++) {
+            for (int j = i; (j > 0) && (p99[j] > p99[j - 1]); j--) {
+                std::swap(counters[j], counters[j - 1]);
+                std::swap(p99[j], p99[j - 1]);
+            }
+        }
+
+        int pages = std::max((count + g_diagnostics_rows - 1) / g_diagnostics_rows, 1);
+        *page = std::min(std::max(*page, 0), pages - 1);
+
+        for (int i = *page * g_diagnostics_rows; (i < count) && (i < (*page + 1) * g_diagnostics_rows); i++) {
+            const Stats::Counter *counter = counters[i];
+            y += 30;
+            GUI::DrawTextf(g_start_x, y, 25, title_colour, "%s  %llu / %llu / 0x%x / %llu / %llu / %llu", counter->name,
+                static_cast<unsigned long long>(counter->count.load()), static_cast<unsigned long long>(counter->errors.load()),
+                counter->last_result.load(), static_cast<unsigned long long>(Stats::GetPercentile(counter, 50) / 1000),
+                static_cast<unsigned long long>(p99[i] / 1000), static_cast<unsigned long long>(counter->max_ns.load() / 1000));
+        }
+
+        GUI::DrawTextf(g_start_x, 640, 25, descr_colour, "按 p99 排序, 第 %d / %d 页 (左 / 右翻页)", *page + 1, pages);
+
+        if (dumped)
+            GUI::DrawTextf(g_start_x, 680, 25, descr_colour, R_SUCCEEDED(dump_result)? "已保存到 %s" : "保存失败: %s", g_stats_path);
+        else
+            GUI::DrawTextf(g_start_x, 680, 25, descr_colour, "按 A 保存到 %s", g_stats_path);
+    }
+
+    // Whether anything `selection` shows differs between two snapshots.
+    static bool PageChanged(int selection, const SwitchIdent::SystemSnapshot *a, const SwitchIdent::SystemSnapshot *b) {
+        if (a->categories != b->categories)
+            return true;
+
+        switch (selection) {
+            case STATE_KERNEL_INFO:
+                return std::memcmp(&a->kernel, &b->kernel, sizeof(a->kernel)) != 0;
+
+            case STATE_SYSTEM_INFO:
+                return std::memcmp(&a->system, &b->system, sizeof(a->system)) != 0;
+
+            case STATE_POWER_INFO:
+                return std::memcmp(&a->power, &b->power, sizeof(a->power)) != 0;
+
+            case STATE_STORAGE_INFO:
+                return std::memcmp(&a->storage, &b->storage, sizeof(a->storage)) != 0;
+
+            case STATE_JOYCON_INFO:
+                return std::memcmp(&a->joycon, &b->joycon, sizeof(a->joycon)) != 0;
+
+            case STATE_MISC_INFO:
+                return std::memcmp(&a->misc, &b->misc, sizeof(a->misc)) != 0;
+
+            default:
+                return false;
+        }
+    }
+
+    // Text measures as zero until the font has loaded, so this runs again once it has.
+    static void Measure(u32 *title_height) {
+        GUI::GetTextDimensions(25, "SwitchIdent", nullptr, title_height);
+        GUI::GetTextDimensions(25, "Item", nullptr, &g_item_height);
+        Menus::Layout();
     }
 
     void Main(void) {
         u32 title_height = 0;
-        GUI::GetTextDimensions(25, "SwitchIdent", nullptr, &title_height);
-        GUI::GetTextDimensions(25, "Item", nullptr, &g_item_height);
+        Menus::Measure(&title_height);
         
-        int banner_width = 200;
+        int banner_width = Atlas::Sprites[Atlas::Sprite_Banner].w;
         int selection = STATE_KERNEL_INFO;
-        Result ret = 0;
-        
-        FsDeviceOperator fsDeviceOperator;
-        if (R_FAILED(ret = fsOpenDeviceOperator(&fsDeviceOperator)))
-            std::printf("fsOpenDeviceOperator() failed: 0x%x.\n\n", ret);
-            
-        g_is_sd_inserted = SwitchIdent::IsSDCardInserted(&fsDeviceOperator);
-        g_is_gamecard_inserted = SwitchIdent::IsGameCardInserted(&fsDeviceOperator);
-        fsDeviceOperatorClose(&fsDeviceOperator);
-        
-        padConfigureInput(1, HidNpadStyleSet_NpadStandard);
+        padConfigureInput(8, HidNpadStyleSet_NpadStandard);
         padInitializeDefault(&g_pad);
         padUpdate(&g_pad);
         
@@ -255,26 +360,57 @@ namespace Menus {
             "存储",
             "手柄",
             "杂项",
+            "诊断",
             "退出"
         };
 
-        while(appletMainLoop()) {
-            GUI::ClearScreen(bg_colour);
-            GUI::DrawRect(0, 0, 1280, 50, status_bar_colour);
-            GUI::DrawRect(0, 50, 400, 670, menu_bar_colour);
-            
-            GUI::DrawTextf(30, ((50 - title_height) / 2), 25, title_colour, "SwitchIdent v%d.%d", VERSION_MAJOR, VERSION_MINOR);
-            GUI::DrawImage(banner, 400 + ((880 - (banner_width)) / 2),  80);
-            
-            GUI::DrawRect(0, 50 + (g_item_dist * selection), 400, g_item_dist, selector_colour);
+        // The diagnostics page shares the misc icon.
+        const Atlas::Sprite icons[] = {
+            Atlas::Sprite_Kernel,
+            Atlas::Sprite_System,
+            Atlas::Sprite_Power,
+            Atlas::Sprite_Storage,
+            Atlas::Sprite_Joycon,
+            Atlas::Sprite_Misc,
+            Atlas::Sprite_Misc,
+            Atlas::Sprite_Exit
+        };
 
-            for (int i = 0; i < MAX_ITEMS; i++) {
-                GUI::DrawImage(menu_icons[i], 20, 52 + ((g_item_dist - g_item_height) / 2) + (g_item_dist * i));
-                GUI::DrawText(75, 50 + ((g_item_dist - g_item_height) / 2) + (g_item_dist * i), 25, title_colour, items[i]);
-            }
-            
+        // Snapshot categories each page reads; their services are started the first time the page is opened.
+        const u32 page_categories[] = {
+            SwitchIdent::SnapshotCategory_Kernel,
+            SwitchIdent::SnapshotCategory_System,
+            SwitchIdent::SnapshotCategory_Power,
+            SwitchIdent::SnapshotCategory_Storage,
+            SwitchIdent::SnapshotCategory_Joycon,
+            SwitchIdent::SnapshotCategory_Misc,
+            0,
+            0
+        };
+
+        bool first_frame = true;
+        Result dump_result = 0;
+        bool dumped = false;
+        int diagnostics_page = 0;
+
+        static Stats::Counter *render_counter = Stats::GetCounter("Menus::Render");
+        static Stats::Counter *skip_counter = Stats::GetCounter("Menus::Skip");
+        static SwitchIdent::SystemSnapshot drawn_snapshot;
+        int drawn_selection = -1;
+        u64 drawn_time = 0;
+
+        while(appletMainLoop()) {
             padUpdate(&g_pad);
             u32 kDown = padGetButtonsDown(&g_pad);
+
+            // Nothing is drawn or sampled while out of focus; the first frame back is always rebuilt.
+            Governor::State state = Governor::Update(kDown != 0);
+            if (state == Governor::State_Suspended) {
+                drawn_selection = -1;
+                drawn_time = 0;
+                std::this_thread::sleep_for(std::chrono::nanoseconds(Governor::GetPollInterval(state)));
+                continue;
+            }
             
             if (kDown & HidNpadButton_AnyDown)
                 selection++;
@@ -286,36 +422,95 @@ namespace Menus {
             if (selection < 0) 
                 selection = STATE_EXIT;
                 
-            switch (selection) {
-                case STATE_KERNEL_INFO:
-                    Menus::KernelInfo();
-                    break;
-                
-                case STATE_SYSTEM_INFO:
-                    Menus::SystemInfo();
-                    break;
-                
-                case STATE_POWER_INFO:
-                    Menus::PowerInfo();
-                    break;
-                
-                case STATE_STORAGE_INFO:
-                    Menus::StorageInfo();
-                    break;
-
-                case STATE_JOYCON_INFO:
-                    Menus::JoyconInfo();
-                    break;
-                    
-                case STATE_MISC_INFO:
-                    Menus::MiscInfo();
-                    break;
-
-                default:
-                    break;
+            Services::RequireCategories(page_categories[selection]);
+
+            // The first frames go out before the font and atlas are up; each piece that arrives forces a rebuild.
+            bool assets_arrived = GUI::UpdateLoading();
+            if (assets_arrived)
+                Menus::Measure(&title_height);
+
+            // A page has nothing to show until the sampler has read its categories at least once.
+            const SwitchIdent::SystemSnapshot *snapshot = Sampler::GetSnapshot();
+            bool page_ready = (snapshot->categories & page_categories[selection]) == page_categories[selection];
+            u64 now = Stats::GetTimeNs();
+
+            // The frame is only rebuilt on input, a page change or a change to something the page shows; otherwise
+            // the last presented frame stays up and the loop sleeps until the next snapshot or input poll, which the
+            // governor spaces out further once the user has been idle for a while.
+            bool damaged = assets_arrived || (kDown != 0) || (selection != drawn_selection) || Menus::PageChanged(selection, snapshot, &drawn_snapshot) ||
+                ((selection == STATE_DIAGNOSTICS_INFO) && ((now - drawn_time) >= g_diagnostics_interval_ns));
+
+            if (!damaged) {
+                Sampler::WaitForSnapshot(snapshot->sequence, Governor::GetPollInterval(state));
+                continue;
+            }
+
+            GUI::ClearScreen(bg_colour);
+            GUI::DrawRect(0, 0, 1280, 50, status_bar_colour);
+            GUI::DrawRect(0, 50, 400, 670, menu_bar_colour);
+            
+            GUI::DrawTextf(30, ((50 - title_height) / 2), 25, title_colour, "SwitchIdent v%d.%d", VERSION_MAJOR, VERSION_MINOR);
+            GUI::DrawRect(0, 50 + (g_item_dist * selection), 400, g_item_dist, selector_colour);
+
+            GUI::DrawSprite(Atlas::Sprite_Banner, 400 + ((880 - (banner_width)) / 2),  80);
+
+            for (int i = 0; i < MAX_ITEMS; i++)
+                GUI::DrawSprite(icons[i], 20, 52 + ((g_item_dist - g_item_height) / 2) + (g_item_dist * i));
+
+            for (int i = 0; i < MAX_ITEMS; i++)
+                GUI::DrawText(75, 50 + ((g_item_dist - g_item_height) / 2) + (g_item_dist * i), 25, title_colour, items[i]);
+
+            if (page_ready && !Menus::DrawPage(selection, snapshot)) {
+                switch (selection) {
+                    case STATE_STORAGE_INFO:
+                        Menus::StorageInfo(&snapshot->storage);
+                        break;
+
+                    case STATE_JOYCON_INFO:
+                        Menus::JoyconInfo(&snapshot->joycon);
+                        break;
+                        
+                    case STATE_DIAGNOSTICS_INFO:
+                        if (kDown & HidNpadButton_A) {
+                            dump_result = Stats::Dump(g_stats_path);
+                            dumped = true;
+                        }
+
+                        if (kDown & HidNpadButton_AnyRight)
+                            diagnostics_page++;
+                        else if (kDown & HidNpadButton_AnyLeft)
+                            diagnostics_page--;
+
+                        Menus::DiagnosticsInfo(dump_result, dumped, &diagnostics_page);
+                        break;
+
+                    default:
+                        break;
+                }
             }
             
             GUI::Render();
+            Stats::Record(render_counter, Stats::GetTimeNs() - now, 0);
+
+            // Every vsync that went by since the last present without one of its own is a skipped present. Time
+            // spent suspended does not count; the app does not own the display then.
+            if (drawn_time != 0) {
+                u64 vsyncs = (now - drawn_time + (g_vsync_ns / 2)) / g_vsync_ns;
+                if (vsyncs > 1)
+                    skip_counter->count.fetch_add(vsyncs - 1, std::memory_order_relaxed);
+            }
+
+            drawn_snapshot = *snapshot;
+            drawn_selection = selection;
+            drawn_time = now;
+
+            if (first_frame) {
+                Services::MarkFirstFrame();
+                first_frame = false;
+            }
+
+            if (assets_arrived && GUI::IsLoaded())
+                Services::MarkFullyLoaded();
             
             if ((kDown & HidNpadButton_Plus) || ((kDown & HidNpadButton_A) && (selection == STATE_EXIT)))
                 break;
@@ -1,8 +1,12 @@
 #include <cstdio>
 
 #include "common.hpp"
+#include "stats.hpp"
 
 namespace SwitchIdent {
+    static FsDeviceOperator g_device_operator;
+    static bool g_device_operator_open = false;
+
     const char *GetOperationMode(void) {
         if (appletGetOperationMode() == AppletOperationMode_Handheld)
             return "Handheld";
@@ -14,7 +18,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = setsysGetWirelessLanEnableFlag(&out)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetWirelessLanEnableFlag, &out)))
             std::printf("setsysGetWirelessLanEnableFlag() failed: 0x%x.\n\n", ret);
         
         return out;
@@ -24,7 +28,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = setsysGetBluetoothEnableFlag(&out)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetBluetoothEnableFlag, &out)))
             std::printf("setsysGetBluetoothEnableFlag() failed: 0x%x.\n\n", ret);
         
         return out;
@@ -34,7 +38,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = setsysGetNfcEnableFlag(&out)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetNfcEnableFlag, &out)))
             std::printf("setsysGetNfcEnableFlag() failed: 0x%x.\n\n", ret);
         
         return out;
@@ -44,7 +48,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = setsysGetAutoUpdateEnableFlag(&out)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetAutoUpdateEnableFlag, &out)))
             std::printf("setsysGetAutoUpdateEnableFlag() failed: 0x%x.\n\n", ret);
         
         return out;
@@ -54,7 +58,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = setsysGetConsoleInformationUploadFlag(&out)))
+        if (R_FAILED(ret = STATS_CALL(setsysGetConsoleInformationUploadFlag, &out)))
             std::printf("setsysGetConsoleInformationUploadFlag() failed: 0x%x.\n\n", ret);
             
         return out;
@@ -64,7 +68,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = fsDeviceOperatorIsSdCardInserted(fsDeviceOperator, &out)))
+        if (R_FAILED(ret = STATS_CALL(fsDeviceOperatorIsSdCardInserted, fsDeviceOperator, &out)))
             std::printf("fsDeviceOperatorIsSdCardInserted() failed: 0x%x.\n\n", ret);
             
         return out;
@@ -74,9 +78,32 @@ namespace SwitchIdent {
         Result ret = 0;
         bool out = false;
         
-        if (R_FAILED(ret = fsDeviceOperatorIsGameCardInserted(fsDeviceOperator, &out)))
+        if (R_FAILED(ret = STATS_CALL(fsDeviceOperatorIsGameCardInserted, fsDeviceOperator, &out)))
             std::printf("fsDeviceOperatorIsGameCardInserted() failed: 0x%x.\n\n", ret);
             
         return out;
     }
+    
+    // Opened on first use and shared by every caller until CloseDeviceOperator().
+    FsDeviceOperator *GetDeviceOperator(void) {
+        Result ret = 0;
+        
+        if (!g_device_operator_open) {
+            if (R_FAILED(ret = STATS_CALL(fsOpenDeviceOperator, &g_device_operator))) {
+                std::printf("fsOpenDeviceOperator() failed: 0x%x.\n\n", ret);
+                return nullptr;
+            }
+            
+            g_device_operator_open = true;
+        }
+        
+        return &g_device_operator;
+    }
+    
+    void CloseDeviceOperator(void) {
+        if (g_device_operator_open) {
+            fsDeviceOperatorClose(&g_device_operator);
+            g_device_operator_open = false;
+        }
+    }
 }
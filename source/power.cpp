@@ -1,5 +1,6 @@
 #include <cstdio>
 #include "common.hpp"
+#include "stats.hpp"
 
 namespace SwitchIdent {
     
@@ -22,7 +23,7 @@ namespace SwitchIdent {
         Result ret = 0;
         u32 percentage = 0;
         
-        if (R_FAILED(ret = psmGetBatteryChargePercentage(&percentage)))
+        if (R_FAILED(ret = STATS_CALL(psmGetBatteryChargePercentage, &percentage)))
             return -1;
         
         return percentage;
@@ -32,7 +33,7 @@ namespace SwitchIdent {
         Result ret = 0;
         PsmChargerType charger_type;
         
-        if (R_FAILED(ret = psmGetChargerType(&charger_type)))
+        if (R_FAILED(ret = STATS_CALL(psmGetChargerType, &charger_type)))
             return nullptr;
             
         if (charger_type == PsmChargerType_EnoughPower)
@@ -49,7 +50,7 @@ namespace SwitchIdent {
         Result ret = 0;
         PsmChargerType charger_type;
         
-        if (R_FAILED(ret = psmGetChargerType(&charger_type)))
+        if (R_FAILED(ret = STATS_CALL(psmGetChargerType, &charger_type)))
             return false;
             
         return charger_type != PsmChargerType_Unconnected;
@@ -59,7 +60,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool is_charing_enabled = 0;
         
-        if (R_FAILED(ret = psmIsBatteryChargingEnabled(&is_charing_enabled)))
+        if (R_FAILED(ret = STATS_CALL(psmIsBatteryChargingEnabled, &is_charing_enabled)))
             return -1;
         
         return is_charing_enabled;
@@ -76,7 +77,7 @@ namespace SwitchIdent {
             "Unknown"
         };
         
-        if (R_SUCCEEDED(ret = psmGetBatteryVoltageState(&voltage_state))) {
+        if (R_SUCCEEDED(ret = STATS_CALL(psmGetBatteryVoltageState, &voltage_state))) {
             if (voltage_state < 4)
                 return states[voltage_state];
         }
@@ -89,7 +90,7 @@ namespace SwitchIdent {
         Result ret = 0;
         double raw_percentage = 0;
         
-        if (R_FAILED(ret = psmGetRawBatteryChargePercentage(&raw_percentage)))
+        if (R_FAILED(ret = STATS_CALL(psmGetRawBatteryChargePercentage, &raw_percentage)))
             return -1;
             
         return raw_percentage;
@@ -99,7 +100,7 @@ namespace SwitchIdent {
         Result ret = 0;
         bool is_power_supplied = 0;
         
-        if (R_FAILED(ret = psmIsEnoughPowerSupplied(&is_power_supplied)))
+        if (R_FAILED(ret = STATS_CALL(psmIsEnoughPowerSupplied, &is_power_supplied)))
             return -1;
             
         return is_power_supplied;
@@ -109,7 +110,7 @@ namespace SwitchIdent {
         Result ret = 0;
         double age_percentage = 0;
         
-        if (R_FAILED(ret = psmGetBatteryAgePercentage(&age_percentage)))
+        if (R_FAILED(ret = STATS_CALL(psmGetBatteryAgePercentage, &age_percentage)))
             return -1;
             
         return age_percentage;
@@ -119,7 +120,7 @@ namespace SwitchIdent {
         Result ret = 0;
         SetBatteryLot battery_lot;
         
-        if (R_FAILED(ret = setcalGetBatteryLot(&battery_lot)))
+        if (R_FAILED(ret = STATS_CALL(setcalGetBatteryLot, &battery_lot)))
             std::printf("setcalGetBatteryLot() failed: 0x%x.\n\n", ret);
             
         return battery_lot;
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "sampler.hpp"
+#include "stats.hpp"
+#include "triple_buffer.hpp"
+
+namespace Sampler {
+    static const u64 g_max_wait_ns = 1000000000ULL;
+
+    static std::thread g_thread;
+    static std::mutex g_mutex;
+    static std::condition_variable g_cond;
+    static bool g_running = false;
+    static bool g_wake = false;
+    static bool g_paused = false;
+
+    static std::mutex g_publish_mutex;
+    static std::condition_variable g_publish_cond;
+    static u64 g_published_sequence = 0;
+
+    static SwitchIdent::SystemSnapshot g_working;
+    static TripleBuffer<SwitchIdent::SystemSnapshot> g_published;
+
+    static u64 GetTimeNs(void) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void Run(void) {
+        static Stats::Counter *refresh_counter = Stats::GetCounter("SwitchIdent::RefreshSnapshot");
+        std::unique_lock<std::mutex> lock(g_mutex);
+
+        while (g_running) {
+            lock.unlock();
+
+            // Service calls may block for a long time; only this thread ever waits on them.
+            u64 next_refresh = 0;
+            u64 start = Sampler::GetTimeNs();
+            if (SwitchIdent::RefreshSnapshot(&g_working, start, &next_refresh)) {
+                // Only passes that read something are timed; the rest cost nothing worth reporting.
+                Stats::Record(refresh_counter, Sampler::GetTimeNs() - start, 0);
+                g_working.sequence++;
+                *g_published.GetWriteBuffer() = g_working;
+                g_published.Publish();
+
+                {
+                    std::lock_guard<std::mutex> publish_lock(g_publish_mutex);
+                    g_published_sequence = g_working.sequence;
+                }
+
+                g_publish_cond.notify_all();
+            }
+
+            lock.lock();
+            u64 now = Sampler::GetTimeNs();
+            if (next_refresh > now) {
+                u64 wait_ns = (next_refresh - now) < g_max_wait_ns? (next_refresh - now) : g_max_wait_ns;
+                g_cond.wait_for(lock, std::chrono::nanoseconds(wait_ns), [] { return !g_running || g_wake; });
+            }
+
+            g_wake = false;
+
+            while (g_running && g_paused)
+                g_cond.wait(lock);
+        }
+    }
+
+    void Init(void) {
+        g_running = true;
+        g_thread = std::thread(Sampler::Run);
+    }
+
+    void Exit(void) {
+        if (!g_thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_running = false;
+        }
+
+        g_cond.notify_all();
+        g_thread.join();
+    }
+
+    void Wake(void) {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_wake = true;
+        }
+
+        g_cond.notify_all();
+    }
+
+    void SetPaused(bool paused) {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_paused = paused;
+            g_wake = true;
+        }
+
+        g_cond.notify_all();
+    }
+
+    const SwitchIdent::SystemSnapshot *GetSnapshot(void) {
+        return g_published.Acquire();
+    }
+
+    bool WaitForSnapshot(u64 sequence, u64 timeout_ns) {
+        std::unique_lock<std::mutex> lock(g_publish_mutex);
+        return g_publish_cond.wait_for(lock, std::chrono::nanoseconds(timeout_ns), [sequence] { return g_published_sequence != sequence; });
+    }
+}
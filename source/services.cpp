@@ -0,0 +1,224 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "common.hpp"
+#include "events.hpp"
+#include "gui.hpp"
+#include "sampler.hpp"
+#include "services.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+
+namespace Services {
+    enum ServiceId {
+        ServiceId_Romfs = 0,
+        ServiceId_Socket,
+        ServiceId_Set,
+        ServiceId_SetSys,
+        ServiceId_SetCal,
+        ServiceId_Spl,
+        ServiceId_Nifm,
+        ServiceId_Applet,
+        ServiceId_Apm,
+        ServiceId_Ns,
+        ServiceId_Psm,
+        ServiceId_Clock,
+        ServiceId_WlanInf,
+        ServiceId_Count
+    };
+
+    enum ServiceState {
+        ServiceState_Idle = 0,
+        ServiceState_Starting,
+        ServiceState_Ready,
+        ServiceState_Failed
+    };
+
+    struct ServiceEntry {
+        const char *name;
+        Result (*init)(void);
+        void (*exit)(void);
+        u32 categories; // Snapshot categories that read from this service.
+        bool lazy;      // Deferred until a page needing `categories` is first opened.
+    };
+
+    static const ServiceEntry g_services[ServiceId_Count] = {
+        { "romfs", [] { return STATS_CALL(romfsInit); }, [] { romfsExit(); }, 0, false },
+        { "socket", [] {
+            Result ret = STATS_CALL(socketInitializeDefault);
+            if (R_SUCCEEDED(ret))
+                nxlinkStdio();
+            return ret;
+        }, [] { socketExit(); }, SwitchIdent::SnapshotCategory_Misc, false },
+        { "set", [] { return STATS_CALL(setInitialize); }, [] { setExit(); }, SwitchIdent::SnapshotCategory_System, true },
+        { "setsys", [] { return STATS_CALL(setsysInitialize); }, [] { setsysExit(); },
+            SwitchIdent::SnapshotCategory_Kernel | SwitchIdent::SnapshotCategory_System | SwitchIdent::SnapshotCategory_Misc, false },
+        { "setcal", [] { return STATS_CALL(setcalInitialize); }, [] { setcalExit(); },
+            SwitchIdent::SnapshotCategory_Power | SwitchIdent::SnapshotCategory_Misc, true },
+        { "spl", [] { return STATS_CALL(splInitialize); }, [] { splExit(); }, SwitchIdent::SnapshotCategory_Kernel, false },
+        // gethostname() asks nifm for the current IP address.
+        { "nifm", [] { return STATS_CALL(nifmInitialize, NifmServiceType_User); }, [] { nifmExit(); }, SwitchIdent::SnapshotCategory_Misc, true },
+        { "applet", [] { return STATS_CALL(appletInitialize); }, [] { appletExit(); }, SwitchIdent::SnapshotCategory_Misc, false },
+        // Not read by any page, so it is never started.
+        { "apm", [] { return STATS_CALL(apmInitialize); }, [] { apmExit(); }, 0, true },
+        { "ns", [] { return STATS_CALL(nsInitialize); }, [] { nsExit(); }, SwitchIdent::SnapshotCategory_Storage, true },
+        // Eager: Events::Init() binds the psm state-change event.
+        { "psm", [] { return STATS_CALL(psmInitialize); }, [] { psmExit(); }, SwitchIdent::SnapshotCategory_Power, false },
+        { "clkrst/pcv", [] {
+            if (hosversionAtLeast(8, 0, 0))
+                return STATS_CALL(clkrstInitialize);
+            return STATS_CALL(pcvInitialize);
+        }, [] {
+            if (hosversionAtLeast(8, 0, 0)) {
+                SwitchIdent::CloseClockSessions();
+                clkrstExit();
+            }
+            else
+                pcvExit();
+        }, SwitchIdent::SnapshotCategory_System, true },
+        { "wlaninf", [] { return STATS_CALL(wlaninfInitialize); }, [] { wlaninfExit(); }, SwitchIdent::SnapshotCategory_System, true },
+    };
+
+    static std::atomic<int> g_states[ServiceId_Count];
+    static std::thread g_threads[ServiceId_Count];
+    static std::mutex g_mutex;
+    static std::condition_variable g_cond;
+
+    static u64 g_init_time = 0;
+    static std::atomic<u64> g_first_frame_time(0);
+    static std::atomic<u64> g_fully_loaded_time(0);
+
+    static bool IsSettled(int id) {
+        int state = g_states[id].load();
+        return (state == ServiceState_Ready) || (state == ServiceState_Failed);
+    }
+
+    static void Wait(int id) {
+        std::unique_lock<std::mutex> lock(g_mutex);
+        g_cond.wait(lock, [id] { return Services::IsSettled(id); });
+    }
+
+    // A category is handed to the sampler once every service it reads from has settled; a failed service still
+    // counts, so its page shows the failure values instead of waiting forever.
+    static void UpdateCategories(void) {
+        u32 ready = 0;
+
+        for (u32 category = SwitchIdent::SnapshotCategory_Kernel; category & SwitchIdent::SnapshotCategory_All; category <<= 1) {
+            bool is_ready = true;
+
+            for (int i = 0; i < ServiceId_Count; i++) {
+                if ((g_services[i].categories & category) && !Services::IsSettled(i))
+                    is_ready = false;
+            }
+
+            if (is_ready)
+                ready |= category;
+        }
+
+        SwitchIdent::EnableSnapshotCategories(ready);
+        Sampler::Wake();
+    }
+
+    static void Run(int id) {
+        const ServiceEntry *entry = &g_services[id];
+        Result ret = 0;
+
+        if (R_FAILED(ret = entry->init()))
+            std::printf("%s init failed: 0x%x.\n\n", entry->name, ret);
+
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_states[id].store(R_SUCCEEDED(ret)? ServiceState_Ready : ServiceState_Failed);
+        }
+
+        g_cond.notify_all();
+        Services::UpdateCategories();
+    }
+
+    static void Start(int id) {
+        int expected = ServiceState_Idle;
+        if (!g_states[id].compare_exchange_strong(expected, ServiceState_Starting))
+            return;
+
+        g_threads[id] = std::thread(Services::Run, id);
+    }
+
+    void Init(void) {
+        g_init_time = Stats::GetTimeNs();
+
+        // The sampler only reads categories whose services are up, so it can start right away.
+        Sampler::Init();
+
+        for (int i = 0; i < ServiceId_Count; i++) {
+            if (!g_services[i].lazy)
+                Services::Start(i);
+        }
+
+        // SDL comes up here; fonts and images carry on loading on the GUI's loader thread.
+        Services::Wait(ServiceId_Romfs);
+        GUI::Init();
+
+        Services::Wait(ServiceId_Psm);
+        Events::Init();
+
+        Services::UpdateCategories();
+    }
+
+    void Exit(void) {
+        Events::Exit();
+        Sampler::Exit();
+
+        for (int i = 0; i < ServiceId_Count; i++) {
+            if (g_threads[i].joinable())
+                g_threads[i].join();
+        }
+
+        SwitchIdent::CloseDeviceOperator();
+        GUI::Exit();
+
+        for (int i = ServiceId_Count - 1; i >= 0; i--) {
+            if (g_states[i].load() == ServiceState_Ready)
+                g_services[i].exit();
+
+            g_states[i].store(ServiceState_Idle);
+        }
+    }
+
+    void RequireCategories(u32 categories) {
+        for (int i = 0; i < ServiceId_Count; i++) {
+            if (g_services[i].categories & categories)
+                Services::Start(i);
+        }
+    }
+
+    u64 MarkFirstFrame(void) {
+        u64 expected = 0;
+        u64 elapsed = Stats::GetTimeNs() - g_init_time;
+
+        if (g_first_frame_time.compare_exchange_strong(expected, elapsed))
+            std::printf("Time to first frame: %llu ms\n", (unsigned long long)(elapsed / 1000000));
+
+        return g_first_frame_time.load();
+    }
+
+    u64 GetTimeToFirstFrame(void) {
+        return g_first_frame_time.load();
+    }
+
+    u64 MarkFullyLoaded(void) {
+        u64 expected = 0;
+        u64 elapsed = Stats::GetTimeNs() - g_init_time;
+
+        if (g_fully_loaded_time.compare_exchange_strong(expected, elapsed))
+            std::printf("Time to fully loaded: %llu ms\n", (unsigned long long)(elapsed / 1000000));
+
+        return g_fully_loaded_time.load();
+    }
+
+    u64 GetTimeToFullyLoaded(void) {
+        return g_fully_loaded_time.load();
+    }
+}
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
+
+#include "common.hpp"
+#include "snapshot.hpp"
+
+namespace SwitchIdent {
+    struct SnapshotField {
+        u32 category;
+        RefreshClass refresh_class;
+        void (*refresh)(SystemSnapshot *snapshot);
+        u32 invalidated_by;
+        u64 next_refresh = 0;
+    };
+
+    static std::atomic<u32> g_pending_events(0);
+    static std::atomic<u32> g_enabled_categories(0);
+
+    // Fixed at build time; there is no app configuration to read them from.
+    static const u64 g_refresh_periods[RefreshClass_Count] = {
+        0,                      // RefreshClass_Static: read once
+        10000000000ULL,         // RefreshClass_Slow: 10 s
+        500000000ULL,           // RefreshClass_Fast: 2 Hz
+        0                       // RefreshClass_Event: read once, then on invalidation
+    };
+
+    static SnapshotField g_fields[] = {
+        // Kernel
+        { SnapshotCategory_Kernel, RefreshClass_Static, [](SystemSnapshot *s) { s->kernel.firmware_version = SwitchIdent::GetFirmwareVersion(); }, 0 },
+        { SnapshotCategory_Kernel, RefreshClass_Static, [](SystemSnapshot *s) { s->kernel.hardware_type = SwitchIdent::GetHardwareType(); }, 0 },
+        { SnapshotCategory_Kernel, RefreshClass_Static, [](SystemSnapshot *s) { s->kernel.unit = SwitchIdent::GetUnit(); }, 0 },
+        { SnapshotCategory_Kernel, RefreshClass_Static, [](SystemSnapshot *s) { s->kernel.serial_number = SwitchIdent::GetSerialNumber(); }, 0 },
+        { SnapshotCategory_Kernel, RefreshClass_Static, [](SystemSnapshot *s) { s->kernel.dram_desc = SwitchIdent::GetDramDesc(); }, 0 },
+        { SnapshotCategory_Kernel, RefreshClass_Static, [](SystemSnapshot *s) { s->kernel.device_id = SwitchIdent::GetDeviceID(); }, 0 },
+
+        // System
+        { SnapshotCategory_System, RefreshClass_Static, [](SystemSnapshot *s) { s->system.region = SwitchIdent::GetRegion(); }, 0 },
+        { SnapshotCategory_System, RefreshClass_Fast, [](SystemSnapshot *s) {
+            static const PcvModule modules[] = { PcvModule_CpuBus, PcvModule_GPU, PcvModule_EMC };
+            u32 clocks[3] = { 0 };
+            SwitchIdent::GetClocks(modules, clocks, 3);
+            s->system.cpu_clock = clocks[0];
+            s->system.gpu_clock = clocks[1];
+            s->system.emc_clock = clocks[2];
+        }, 0 },
+        { SnapshotCategory_System, RefreshClass_Slow, [](SystemSnapshot *s) { s->system.wlan_enabled = SwitchIdent::GetWirelessLanEnableFlag(); }, SnapshotEvent_Network },
+        { SnapshotCategory_System, RefreshClass_Fast, [](SystemSnapshot *s) {
+            s->system.wlan_rssi = SwitchIdent::GetWlanRSSI();
+            s->system.wlan_quality = SwitchIdent::GetWlanQuality(s->system.wlan_rssi);
+        }, 0 },
+        { SnapshotCategory_System, RefreshClass_Slow, [](SystemSnapshot *s) { s->system.bluetooth_enabled = SwitchIdent::GetBluetoothEnableFlag(); }, 0 },
+        { SnapshotCategory_System, RefreshClass_Slow, [](SystemSnapshot *s) { s->system.nfc_enabled = SwitchIdent::GetNfcEnableFlag(); }, 0 },
+
+        // Power
+        { SnapshotCategory_Power, RefreshClass_Fast, [](SystemSnapshot *s) { s->power.battery_percentage = SwitchIdent::GetBatteryPercentage(); }, 0 },
+        { SnapshotCategory_Power, RefreshClass_Event, [](SystemSnapshot *s) { s->power.is_charging = SwitchIdent::IsCharging(); }, SnapshotEvent_PowerState },
+        { SnapshotCategory_Power, RefreshClass_Event, [](SystemSnapshot *s) { s->power.voltage_state = SwitchIdent::GetVoltageState(); }, SnapshotEvent_PowerState },
+        { SnapshotCategory_Power, RefreshClass_Event, [](SystemSnapshot *s) { s->power.charger_type = SwitchIdent::GetChargerType(); }, SnapshotEvent_PowerState },
+        { SnapshotCategory_Power, RefreshClass_Event, [](SystemSnapshot *s) { s->power.charging_enabled = SwitchIdent::IsChargingEnabled(); }, SnapshotEvent_PowerState },
+        { SnapshotCategory_Power, RefreshClass_Event, [](SystemSnapshot *s) { s->power.enough_power_supplied = SwitchIdent::IsEnoughPowerSupplied(); }, SnapshotEvent_PowerState },
+        { SnapshotCategory_Power, RefreshClass_Static, [](SystemSnapshot *s) { s->power.battery_lot = SwitchIdent::GetBatteryLot(); }, 0 },
+
+        // Storage
+        { SnapshotCategory_Storage, RefreshClass_Slow, [](SystemSnapshot *s) { SwitchIdent::GetStorageStats(&s->storage); }, SnapshotEvent_SdCard | SnapshotEvent_GameCard },
+
+        // Joycon
+        { SnapshotCategory_Joycon, RefreshClass_Fast, [](SystemSnapshot *s) { SwitchIdent::GetJoyconPowerList(&s->joycon); }, 0 },
+
+        // Misc
+        { SnapshotCategory_Misc, RefreshClass_Slow, [](SystemSnapshot *s) {
+            s->misc.has_ip_address = (gethostname(s->misc.ip_address, sizeof(s->misc.ip_address)) == 0);
+        }, SnapshotEvent_Network },
+        { SnapshotCategory_Misc, RefreshClass_Fast, [](SystemSnapshot *s) { s->misc.operation_mode = SwitchIdent::GetOperationMode(); }, 0 },
+        { SnapshotCategory_Misc, RefreshClass_Slow, [](SystemSnapshot *s) { s->misc.auto_update_enabled = SwitchIdent::GetAutoUpdateEnableFlag(); }, 0 },
+        { SnapshotCategory_Misc, RefreshClass_Slow, [](SystemSnapshot *s) { s->misc.console_info_upload_enabled = SwitchIdent::GetConsoleInformationUploadFlag(); }, 0 },
+        { SnapshotCategory_Misc, RefreshClass_Event, [](SystemSnapshot *s) {
+            FsDeviceOperator *device_operator = SwitchIdent::GetDeviceOperator();
+            s->misc.sd_inserted = device_operator? SwitchIdent::IsSDCardInserted(device_operator) : false;
+        }, SnapshotEvent_SdCard },
+        { SnapshotCategory_Misc, RefreshClass_Event, [](SystemSnapshot *s) {
+            FsDeviceOperator *device_operator = SwitchIdent::GetDeviceOperator();
+            s->misc.gamecard_inserted = device_operator? SwitchIdent::IsGameCardInserted(device_operator) : false;
+        }, SnapshotEvent_GameCard },
+        { SnapshotCategory_Misc, RefreshClass_Static, [](SystemSnapshot *s) { s->misc.bd_addr = SwitchIdent::GetBluetoothBdAddress(); }, 0 },
+        { SnapshotCategory_Misc, RefreshClass_Static, [](SystemSnapshot *s) { s->misc.mac_addr = SwitchIdent::GetWirelessLanMacAddress(); }, 0 },
+    };
+
+    static const int g_field_count = sizeof(g_fields) / sizeof(g_fields[0]);
+
+    bool RefreshSnapshot(SystemSnapshot *snapshot, u64 now_ns, u64 *next_refresh_ns) {
+        bool refreshed = false;
+        u64 next_refresh = UINT64_MAX;
+        u32 events = g_pending_events.exchange(0);
+        u32 enabled = g_enabled_categories.load();
+
+        for (int i = 0; i < g_field_count; i++) {
+            SnapshotField *field = &g_fields[i];
+
+            // Fields whose services are not up yet neither refresh nor count towards the next deadline.
+            if (!(field->category & enabled))
+                continue;
+
+            if (field->invalidated_by & events)
+                field->next_refresh = 0;
+
+            if (field->next_refresh <= now_ns) {
+                field->refresh(snapshot);
+                snapshot->categories |= field->category;
+                refreshed = true;
+
+                if ((field->refresh_class == RefreshClass_Static) || (field->refresh_class == RefreshClass_Event))
+                    field->next_refresh = UINT64_MAX;
+                else
+                    field->next_refresh = now_ns + g_refresh_periods[field->refresh_class];
+            }
+
+            if (field->next_refresh < next_refresh)
+                next_refresh = field->next_refresh;
+        }
+
+        if (next_refresh_ns != nullptr)
+            *next_refresh_ns = next_refresh;
+
+        return refreshed;
+    }
+
+    void InvalidateSnapshot(u32 events) {
+        g_pending_events.fetch_or(events);
+    }
+
+    void EnableSnapshotCategories(u32 categories) {
+        g_enabled_categories.fetch_or(categories);
+    }
+}
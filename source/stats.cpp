@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include "stats.hpp"
+
+namespace Stats {
+    static std::mutex g_mutex;
+    static Counter g_counters[MaxCounters];
+    static std::atomic<int> g_counter_count(0);
+    static Counter g_overflow_counter;
+
+    u64 GetTimeNs(void) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Counter *GetCounter(const char *name) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        int count = g_counter_count.load(std::memory_order_relaxed);
+
+        for (int i = 0; i < count; i++) {
+            if (std::strcmp(g_counters[i].name, name) == 0)
+                return &g_counters[i];
+        }
+
+        if (count == MaxCounters) {
+            g_overflow_counter.name = "(other)";
+            return &g_overflow_counter;
+        }
+
+        g_counters[count].name = name;
+        g_counter_count.store(count + 1, std::memory_order_release);
+        return &g_counters[count];
+    }
+
+    void Record(Counter *counter, u64 elapsed_ns, Result ret) {
+        int bucket = 0;
+        while ((bucket < (NumBuckets - 1)) && ((elapsed_ns >> (bucket + 1)) != 0))
+            bucket++;
+
+        counter->count.fetch_add(1, std::memory_order_relaxed);
+        counter->total_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+        counter->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        counter->last_result.store(ret, std::memory_order_relaxed);
+
+        if (R_FAILED(ret))
+            counter->errors.fetch_add(1, std::memory_order_relaxed);
+
+        u64 max = counter->max_ns.load(std::memory_order_relaxed);
+        while ((elapsed_ns > max) && !counter->max_ns.compare_exchange_weak(max, elapsed_ns, std::memory_order_relaxed));
+    }
+
+    int GetCounterCount(void) {
+        return g_counter_count.load(std::memory_order_acquire);
+    }
+
+    const Counter *GetCounterAt(int index) {
+        return &g_counters[index];
+    }
+
+    u64 GetPercentile(const Counter *counter, u32 percentile) {
+        u64 total = 0;
+        for (int i = 0; i < NumBuckets; i++)
+            total += counter->buckets[i].load(std::memory_order_relaxed);
+
+        if (total == 0)
+            return 0;
+
+        u64 target = ((total * percentile) + 99) / 100;
+        u64 seen = 0;
+
+        for (int i = 0; i < NumBuckets; i++) {
+            seen += counter->buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target)
+                return 1ULL << (i + 1);
+        }
+
+        return 1ULL << NumBuckets;
+    }
+
+    Result Dump(const char *path) {
+        FILE *file = std::fopen(path, "w");
+        if (file == nullptr)
+            return -1;
+
+        std::fprintf(file, "call,count,errors,last_result,mean_us,p50_us,p99_us,max_us\n");
+
+        for (int i = 0; i < Stats::GetCounterCount(); i++) {
+            const Counter *counter = Stats::GetCounterAt(i);
+            u64 count = counter->count.load(std::memory_order_relaxed);
+
+            std::fprintf(file, "%s,%llu,%llu,0x%x,%llu,%llu,%llu,%llu\n", counter->name,
+                (unsigned long long)count,
+                (unsigned long long)counter->errors.load(std::memory_order_relaxed),
+                counter->last_result.load(std::memory_order_relaxed),
+                (unsigned long long)(count? (counter->total_ns.load(std::memory_order_relaxed) / count / 1000) : 0),
+                (unsigned long long)(Stats::GetPercentile(counter, 50) / 1000),
+                (unsigned long long)(Stats::GetPercentile(counter, 99) / 1000),
+                (unsigned long long)(counter->max_ns.load(std::memory_order_relaxed) / 1000));
+        }
+
+        std::fclose(file);
+        return 0;
+    }
+}
@@ -1,12 +1,13 @@
 #include <cstdio>
 #include "common.hpp"
+#include "stats.hpp"
 
 namespace SwitchIdent {
     s64 GetTotalStorage(NcmStorageId storage_id) {
         Result ret = 0;
         s64 total = 0;
         
-        if (R_FAILED(ret = nsGetTotalSpaceSize(storage_id, &total)))
+        if (R_FAILED(ret = STATS_CALL(nsGetTotalSpaceSize, storage_id, &total)))
             std::printf("nsGetFreeSpaceSize() failed: 0x%x.\n\n", ret);
             
         return total;
@@ -16,7 +17,7 @@ namespace SwitchIdent {
         Result ret = 0;
         s64 free = 0;
         
-        if (R_FAILED(ret = nsGetFreeSpaceSize(storage_id, &free)))
+        if (R_FAILED(ret = STATS_CALL(nsGetFreeSpaceSize, storage_id, &free)))
             std::printf("nsGetFreeSpaceSize() failed: 0x%x.\n\n", ret);
             
         return free;
@@ -26,6 +27,28 @@ namespace SwitchIdent {
         return (SwitchIdent::GetTotalStorage(storage_id) - SwitchIdent::GetFreeStorage(storage_id));
     }
     
+    static void QueryStorageUsage(StorageUsage *usage, NcmStorageId storage_id, bool present) {
+        usage->storage_id = storage_id;
+        usage->present = present;
+        usage->total = present? SwitchIdent::GetTotalStorage(storage_id) : 0;
+        usage->free = present? SwitchIdent::GetFreeStorage(storage_id) : 0;
+        usage->used = usage->total - usage->free;
+    }
+    
+    // Not cached: the snapshot's storage field decides how often this runs and re-reads it on SD/gamecard events.
+    // Slots whose media is missing are reported as absent without asking ns about them.
+    void GetStorageStats(StorageStats *stats) {
+        FsDeviceOperator *device_operator = SwitchIdent::GetDeviceOperator();
+        bool is_sd_inserted = device_operator? SwitchIdent::IsSDCardInserted(device_operator) : false;
+        bool is_gamecard_inserted = device_operator? SwitchIdent::IsGameCardInserted(device_operator) : false;
+        
+        StorageUsage *slots = stats->slots;
+        SwitchIdent::QueryStorageUsage(&slots[StorageSlot_SdCard], NcmStorageId_SdCard, is_sd_inserted);
+        SwitchIdent::QueryStorageUsage(&slots[StorageSlot_BuiltInUser], NcmStorageId_BuiltInUser, true);
+        SwitchIdent::QueryStorageUsage(&slots[StorageSlot_BuiltInSystem], NcmStorageId_BuiltInSystem, true);
+        SwitchIdent::QueryStorageUsage(&slots[StorageSlot_GameCard], NcmStorageId_GameCard, is_gamecard_inserted);
+    }
+    
     void GetSizeString(char *string, double size) {
         int i = 0;
         const char *units[] = {"B", "KB", "MB", "GB", "TB", "PB", "EB", "ZB", "YB"};
@@ -1,13 +1,14 @@
 #include <cstdio>
 
 #include "common.hpp"
+#include "stats.hpp"
 
 namespace SwitchIdent {
     u64 GetLanguage(void) {
         Result ret = 0;
         u64 language = 0;
         
-        if (R_FAILED(ret = setGetSystemLanguage(&language)))
+        if (R_FAILED(ret = STATS_CALL(setGetSystemLanguage, &language)))
             std::printf("setGetSystemLanguage() failed: 0x%x.\n\n", ret);
             
         return language;
@@ -27,7 +28,7 @@ namespace SwitchIdent {
             "Unknown"
         };
         
-        if (R_FAILED(ret = setGetRegionCode(&region))) {
+        if (R_FAILED(ret = STATS_CALL(setGetRegionCode, &region))) {
             std::printf("setGetRegionCode() failed: 0x%x.\n\n", ret);
             return regions[7];
         }
@@ -35,36 +36,82 @@ namespace SwitchIdent {
         return regions[region];
     }
     
+    struct ClockSession {
+        PcvModule module;
+        ClkrstSession session;
+    };
+
+    // clkrst sessions are opened on first use and kept until Services::Exit.
+    static ClockSession g_clock_sessions[8];
+    static int g_clock_session_count = 0;
+
+    static ClkrstSession *GetClockSession(PcvModule module) {
+        Result ret = 0;
+        PcvModuleId module_id;
+
+        for (int i = 0; i < g_clock_session_count; i++) {
+            if (g_clock_sessions[i].module == module)
+                return &g_clock_sessions[i].session;
+        }
+
+        if (g_clock_session_count == (sizeof(g_clock_sessions) / sizeof(g_clock_sessions[0])))
+            return nullptr;
+
+        ClockSession *entry = &g_clock_sessions[g_clock_session_count];
+
+        if (R_FAILED(ret = STATS_CALL(pcvGetModuleId, &module_id, module))) {
+            std::printf("pcvGetModuleId() failed: 0x%x.\n\n", ret);
+            return nullptr;
+        }
+
+        if (R_FAILED(ret = STATS_CALL(clkrstOpenSession, &entry->session, module_id, 3))) {
+            std::printf("clkrstOpenSession() failed: 0x%x.\n\n", ret);
+            return nullptr;
+        }
+
+        entry->module = module;
+        g_clock_session_count++;
+        return &entry->session;
+    }
+    
     u32 GetClock(PcvModule module) {
         Result ret = 0;
         u32 out = 0;
         
         if (hosversionAtLeast(8, 0, 0)) {
-            ClkrstSession session = {0};
-            PcvModuleId module_id;
+            ClkrstSession *session = SwitchIdent::GetClockSession(module);
+            
+            if (session == nullptr)
+                return 0;
             
-            if (R_FAILED(ret = pcvGetModuleId(&module_id, module)))
-                std::printf("pcvGetModuleId() failed: 0x%x.\n\n", ret);
-            else if (R_FAILED(ret = clkrstOpenSession(&session, module_id, 3)))
-                std::printf("clkrstOpenSession() failed: 0x%x.\n\n", ret);
-            else if (R_FAILED(ret = clkrstGetClockRate(&session, &out)))
+            if (R_FAILED(ret = STATS_CALL(clkrstGetClockRate, session, &out)))
                 std::printf("clkrstGetClockRate() failed: 0x%x.\n\n", ret);
-            else
-                clkrstCloseSession(&session);
         }
         else {
-            if (R_FAILED(ret = pcvGetClockRate(module, &out)))
+            if (R_FAILED(ret = STATS_CALL(pcvGetClockRate, module, &out)))
                 std::printf("pcvGetClockRate() failed: 0x%x.\n\n", ret);
         }
         
         return out/1000000;
     }
     
+    void GetClocks(const PcvModule *modules, u32 *out, int count) {
+        for (int i = 0; i < count; i++)
+            out[i] = SwitchIdent::GetClock(modules[i]);
+    }
+    
+    void CloseClockSessions(void) {
+        for (int i = 0; i < g_clock_session_count; i++)
+            clkrstCloseSession(&g_clock_sessions[i].session);
+            
+        g_clock_session_count = 0;
+    }
+    
     SetCalBdAddress GetBluetoothBdAddress(void) {
         Result ret = 0;
         SetCalBdAddress bd_addr;
         
-        if (R_FAILED(ret = setcalGetBdAddress(&bd_addr)))
+        if (R_FAILED(ret = STATS_CALL(setcalGetBdAddress, &bd_addr)))
             std::printf("setcalGetBdAddress() failed: 0x%x.\n\n", ret);
             
         return bd_addr;
@@ -74,7 +121,7 @@ namespace SwitchIdent {
         Result ret = 0;
         SetCalMacAddress mac_addr;
         
-        if (R_FAILED(ret = setcalGetWirelessLanMacAddress(&mac_addr)))
+        if (R_FAILED(ret = STATS_CALL(setcalGetWirelessLanMacAddress, &mac_addr)))
             std::printf("setcalGetWirelessLanMacAddress() failed: 0x%x.\n\n", ret);
             
         return mac_addr;
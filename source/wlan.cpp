@@ -1,12 +1,13 @@
 #include <cstdio>
 #include "common.hpp"
+#include "stats.hpp"
 
 namespace SwitchIdent {
     u32 GetWlanState(void) {
         Result ret = 0;
         WlanInfState state;
         
-        if (R_FAILED(ret = wlaninfGetState(&state)))
+        if (R_FAILED(ret = STATS_CALL(wlaninfGetState, &state)))
             return -1;
             
         return state;
@@ -29,7 +30,7 @@ namespace SwitchIdent {
         Result ret = 0;
         s32 rssi = 0;
         
-        if (R_FAILED(ret = wlaninfGetRSSI(&rssi)))
+        if (R_FAILED(ret = STATS_CALL(wlaninfGetRSSI, &rssi)))
             return -1;
         
         return rssi;
@@ -0,0 +1,62 @@
+// Rasterises a character set ahead of time into a glyph cache file that GUI::Load reads in place of running
+// SDL_ttf over the same strings at startup. Built and run on the host by `make glyphs`:
+//
+//   bake_glyphs <font.ttf> <point size> <chars.txt> <out.bin>
+//
+// chars.txt is UTF-8 text, normally written by tools/gather_glyphs.py. The output is tagged with the font's hash and
+// the point size, so the app falls back to rasterising at runtime if either no longer matches.
+#include <cstdio>
+#include <cstdlib>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "assets.hpp"
+#include "SDL_FontCache.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        std::fprintf(stderr, "usage: %s <font.ttf> <point size> <chars.txt> <out.bin>\n", argv[0]);
+        return 1;
+    }
+
+    size_t font_size = 0, chars_size = 0;
+    void *font_data = Assets::ReadFile(argv[1], &font_size);
+    char *chars = static_cast<char *>(Assets::ReadFile(argv[3], &chars_size));
+    int point_size = std::atoi(argv[2]);
+    if ((font_data == nullptr) || (chars == nullptr) || (point_size <= 0)) {
+        std::fprintf(stderr, "bake_glyphs: could not read %s or %s\n", argv[1], argv[3]);
+        return 1;
+    }
+
+    chars = static_cast<char *>(std::realloc(chars, chars_size + 1));
+    chars[chars_size] = '\0';
+
+    if (TTF_Init() != 0)
+        return 1;
+
+    TTF_Font *ttf = TTF_OpenFontRW(SDL_RWFromConstMem(font_data, static_cast<int>(font_size)), 1, point_size);
+    FC_Font *font = FC_CreateFont();
+    FC_SetLoadingString(font, chars);
+
+    SDL_RWops *out = nullptr;
+    bool written = (ttf != nullptr) && FC_PrepareFontFromTTF(font, ttf, FC_MakeColor(0, 0, 0, 255)) &&
+        ((out = SDL_RWFromFile(argv[4], "wb")) != nullptr) &&
+        FC_WritePreparedFont(font, out, Assets::HashFont(font_data, font_size), static_cast<Uint32>(point_size));
+
+    if (out != nullptr)
+        SDL_RWclose(out);
+
+    if (written)
+        std::printf("%s: %u glyphs\n", argv[4], FC_GetNumCodepoints(font));
+    else
+        std::fprintf(stderr, "bake_glyphs: could not write %s\n", argv[4]);
+
+    FC_FreeFont(font);
+    if (ttf != nullptr)
+        TTF_CloseFont(ttf);
+
+    TTF_Quit();
+    std::free(chars);
+    std::free(font_data);
+    return written? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Collects the characters the UI can draw and writes them, UTF-8 encoded, to the file named on the command line.
+
+That is every character in a string literal under source/, plus printable ASCII for the numbers, serials and other
+values only known at runtime. tools/bake_glyphs.cpp rasterises this set into romfs/glyphs.bin; `make glyphs` runs
+both. Characters missing from the set are still rendered on first use, just not ahead of time.
+"""
+
+import os
+import re
+import sys
+
+SOURCE_DIR = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "source")
+# A C string literal, allowing escaped quotes; #include lines are skipped before matching.
+LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+ESCAPES = {"n": "\n", "t": "\t", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+
+def unescape(text):
+    return re.sub(r"\\(.)", lambda m: ESCAPES.get(m.group(1), m.group(1)), text)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(f"usage: {sys.argv[0]} <out.txt>")
+
+    chars = {chr(c) for c in range(0x20, 0x7F)}
+    for name in sorted(os.listdir(SOURCE_DIR)):
+        if not name.endswith(".cpp"):
+            continue
+
+        with open(os.path.join(SOURCE_DIR, name), encoding="utf-8") as f:
+            for line in f:
+                if line.lstrip().startswith("#include"):
+                    continue
+                for literal in LITERAL.findall(line):
+                    chars.update(c for c in unescape(literal) if c.isprintable())
+
+    with open(sys.argv[1], "w", encoding="utf-8") as f:
+        f.write("".join(sorted(chars)))
+
+    print(f"{sys.argv[1]}: {len(chars)} characters")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Packs the UI images in assets/ into one atlas, stored pre-decoded and LZ4-compressed in romfs/assets.bin, and
+writes the matching sprite table to include/atlas.hpp.
+
+Run `make atlas` (or this script from the repository root) after changing anything in assets/. Only the Python
+standard library is needed, so it works with the Python that ships with most devkitPro setups.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+# Sprite order is the Atlas::Sprite enum order.
+SPRITES = [
+    ("Banner", "banner.png"),
+    ("Drive", "drive.png"),
+    ("Kernel", "kernel.png"),
+    ("System", "system.png"),
+    ("Power", "power.png"),
+    ("Storage", "storage.png"),
+    ("Joycon", "joycon.png"),
+    ("Misc", "misc.png"),
+    ("Exit", "exit.png"),
+]
+
+ATLAS_WIDTH = 512
+SDL_PIXELFORMAT_RGBA8888 = 0x16462004
+BUNDLE_VERSION = 2  # Assets::g_bundle_version in source/assets.cpp.
+PADDING = 1  # Transparent border so linear filtering never samples a neighbour.
+
+
+def read_png(path):
+    """Returns (width, height, rows) with rows as RGBA8 bytearrays; supports 8-bit RGB/RGBA non-interlaced PNGs."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit(f"{path}: not a PNG")
+
+    pos, idat = 8, b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, colour, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"IDAT":
+            idat += body
+        pos += 12 + length
+
+    if depth != 8 or colour not in (2, 6) or interlace != 0:
+        sys.exit(f"{path}: only 8-bit non-interlaced RGB/RGBA PNGs are supported")
+
+    bpp = 4 if colour == 6 else 3
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+    rows, prev = [], bytearray(stride)
+
+    for y in range(height):
+        filter_type = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if filter_type == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif filter_type == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif filter_type == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif filter_type == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        prev = line
+
+        if bpp == 3:
+            rgba = bytearray()
+            for x in range(width):
+                rgba += line[x * 3:x * 3 + 3] + b"\xff"
+            line = rgba
+        rows.append(line)
+
+    return width, height, rows
+
+
+def lz4_compress(data):
+    """Compresses `data` into one raw LZ4 block (no frame header), which source/assets.cpp decodes. Greedy matching
+    on a hash of the next four bytes; plenty for an atlas that is mostly transparent."""
+    MIN_MATCH, LAST_LITERALS, MF_LIMIT = 4, 5, 12
+    out, table = bytearray(), {}
+    anchor, pos, end = 0, 0, len(data)
+
+    def write_length(value):
+        while value >= 255:
+            out.append(255)
+            value -= 255
+        out.append(value)
+
+    def write_sequence(literals, match_length, offset):
+        token_lit = min(len(literals), 15)
+        token_match = 0 if match_length is None else min(match_length - MIN_MATCH, 15)
+        out.append((token_lit << 4) | token_match)
+        if len(literals) >= 15:
+            write_length(len(literals) - 15)
+        out.extend(literals)
+        if match_length is not None:
+            out.extend(struct.pack("<H", offset))
+            if match_length - MIN_MATCH >= 15:
+                write_length(match_length - MIN_MATCH - 15)
+
+    while pos + MF_LIMIT < end:
+        key = data[pos:pos + MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = pos
+
+        if candidate is None or pos - candidate > 0xFFFF:
+            pos += 1
+            continue
+
+        # The last five bytes are always literals, so a match stops short of them.
+        length, limit = MIN_MATCH, end - LAST_LITERALS
+        while pos + length < limit and data[candidate + length] == data[pos + length]:
+            length += 1
+
+        write_sequence(data[anchor:pos], length, pos - candidate)
+        pos += length
+        anchor = pos
+
+    write_sequence(data[anchor:], None, 0)
+    return bytes(out)
+
+
+def write_bundle(path, images):
+    """Writes [(name, width, height, rows)] as an Assets bundle (see source/assets.cpp) of SDL_PIXELFORMAT_RGBA8888
+    pixels, i.e. one little-endian 0xRRGGBBAA word per pixel, which the texture takes without conversion. Each image
+    is stored as an LZ4 block."""
+    header_size, entry_size = 16, 52
+    offset = header_size + entry_size * len(images)
+    entries, blobs = b"", b""
+
+    for name, width, height, rows in images:
+        pixels = bytearray()
+        for row in rows:
+            for x in range(width):
+                r, g, b, a = row[x * 4:x * 4 + 4]
+                pixels += bytes((a, b, g, r))
+
+        packed = lz4_compress(bytes(pixels))
+        offset += -offset % 16
+        blobs += bytes(-(header_size + entry_size * len(images) + len(blobs)) % 16)
+        entries += struct.pack("<24sIIIIIII", name.encode(), SDL_PIXELFORMAT_RGBA8888, width, height, width * 4, offset,
+                               len(pixels), len(packed))
+        blobs += packed
+        offset += len(packed)
+        print(f"{name}: {len(pixels)} bytes of pixels, {len(packed)} as LZ4")
+
+    with open(path, "wb") as f:
+        f.write(struct.pack("<4sIII", b"SIAB", BUNDLE_VERSION, len(images), 0))
+        f.write(entries)
+        f.write(blobs)
+
+
+def pack(images):
+    """Shelf-packs the images tallest first; returns {name: (x, y)} and the atlas height."""
+    placements, x, y, shelf = {}, 0, 0, 0
+    for name, (w, h, _) in sorted(images.items(), key=lambda item: (-item[1][1], item[0])):
+        if x + w + PADDING > ATLAS_WIDTH:
+            x, y, shelf = 0, y + shelf, 0
+        placements[name] = (x + PADDING, y + PADDING)
+        x += w + PADDING
+        shelf = max(shelf, h + PADDING)
+
+    height = 1
+    while height < y + shelf + PADDING:
+        height *= 2
+    return placements, height
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    images = {name: read_png(os.path.join(root, "assets", file)) for name, file in SPRITES}
+    placements, height = pack(images)
+
+    atlas = [bytearray(ATLAS_WIDTH * 4) for _ in range(height)]
+    for name, (w, h, rows) in images.items():
+        px, py = placements[name]
+        for row in range(h):
+            atlas[py + row][px * 4:(px + w) * 4] = rows[row]
+
+    write_bundle(os.path.join(root, "romfs", "assets.bin"), [("atlas", ATLAS_WIDTH, height, atlas)])
+
+    lines = [
+        "// Generated by tools/pack_atlas.py from assets/*.png; do not edit.",
+        "#ifndef _SWITCHIDENT_ATLAS_H_",
+        "#define _SWITCHIDENT_ATLAS_H_",
+        "",
+        "namespace Atlas {",
+        f"    static const int Width = {ATLAS_WIDTH};",
+        f"    static const int Height = {height};",
+        "",
+        "    enum Sprite {",
+    ]
+    lines += [f"        Sprite_{name}{' = 0' if i == 0 else ''}," for i, (name, _) in enumerate(SPRITES)]
+    lines += [
+        "        Sprite_Count",
+        "    };",
+        "",
+        "    struct SpriteRect {",
+        "        int x;",
+        "        int y;",
+        "        int w;",
+        "        int h;",
+        "    };",
+        "",
+        "    static const SpriteRect Sprites[Sprite_Count] = {",
+    ]
+    for name, _ in SPRITES:
+        w, h, _ = images[name]
+        x, y = placements[name]
+        lines.append(f"        {{ {x}, {y}, {w}, {h} }}, // Sprite_{name}")
+    lines += ["    };", "}", "", "#endif", ""]
+
+    with open(os.path.join(root, "include", "atlas.hpp"), "w") as f:
+        f.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()